@@ -14,17 +14,20 @@ Description:
 #define FOSSIL_TEST_PLATFORM_H
 
 #include "common.h" // for introspection data
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h> // cache descriptors when sysfs is not there
+#endif
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
-// Utility function to get the architecture
-static inline char* _fossil_test_get_architecture(void) {
-    char* arch = malloc(10 * sizeof(char));
-    if (arch == NULL) {
-        return NULL;
+// Utility function to get the architecture, the result is cached in static storage
+static inline const char* _fossil_test_get_architecture(void) {
+    static char arch[10] = {0};
+    if (arch[0] != '\0') {
+        return arch;
     }
 #ifdef _WIN32
     SYSTEM_INFO sysinfo;
@@ -58,11 +61,11 @@ static inline char* _fossil_test_get_architecture(void) {
     return arch;
 }
 
-// Utility function to get the OS name
-static inline char* _fossil_test_get_os_name(void) {
-    char* os_name = malloc(20 * sizeof(char));
-    if (os_name == NULL) {
-        return NULL;
+// Utility function to get the OS name, the result is cached in static storage
+static inline const char* _fossil_test_get_os_name(void) {
+    static char os_name[20] = {0};
+    if (os_name[0] != '\0') {
+        return os_name;
     }
 #ifdef _WIN32
     strncpy(os_name, "Windows", 19);
@@ -137,6 +140,268 @@ static inline int _fossil_test_get_memory_size(void) {
 #endif
 }
 
+// Utility function to read the first line of a small system file, without the newline
+static inline bool _fossil_test_read_first_line(const char *path, char *line, size_t size) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+    bool ok = fgets(line, (int)size, file) != NULL;
+    fclose(file);
+    if (ok) {
+        line[strcspn(line, "\r\n")] = '\0';
+    }
+    return ok;
+}
+
+// Utility function to get the CPU model name, the result is cached in static storage
+static inline const char* _fossil_test_get_cpu_model(void) {
+    static char model[128] = {0};
+    if (model[0] != '\0') {
+        return model;
+    }
+    strncpy(model, "unknown", sizeof(model) - 1);
+#if defined(__APPLE__)
+    size_t size = sizeof(model);
+    if (sysctlbyname("machdep.cpu.brand_string", model, &size, NULL, 0) != 0) {
+        strncpy(model, "unknown", sizeof(model) - 1);
+    }
+#elif defined(__linux__)
+    FILE *file = fopen("/proc/cpuinfo", "r");
+    if (file != NULL) {
+        char line[256];
+        while (fgets(line, sizeof(line), file) != NULL) {
+            if (strncmp(line, "model name", 10) == 0 || strncmp(line, "Model", 5) == 0) {
+                char *value = strchr(line, ':');
+                if (value != NULL) {
+                    value += strspn(value + 1, " \t") + 1;
+                    value[strcspn(value, "\r\n")] = '\0';
+                    strncpy(model, value, sizeof(model) - 1);
+                    break;
+                }
+            }
+        }
+        fclose(file);
+    }
+#endif
+    model[sizeof(model) - 1] = '\0';
+    return model;
+}
+
+// Utility function to get the current frequency of the first CPU in MHz, 0 when unknown
+static inline int _fossil_test_get_cpu_mhz(void) {
+#if defined(__linux__)
+    char line[64];
+    if (_fossil_test_read_first_line("/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq", line, sizeof(line))) {
+        return atoi(line) / 1000;
+    }
+    FILE *file = fopen("/proc/cpuinfo", "r");
+    int mhz = 0;
+    if (file != NULL) {
+        char entry[256];
+        while (fgets(entry, sizeof(entry), file) != NULL) {
+            char *value = strchr(entry, ':');
+            if (strncmp(entry, "cpu MHz", 7) == 0 && value != NULL) {
+                mhz = (int)atof(value + 1);
+                break;
+            }
+        }
+        fclose(file);
+    }
+    return mhz;
+#elif defined(__APPLE__)
+    int64_t hz = 0;
+    size_t size = sizeof(hz);
+    if (sysctlbyname("hw.cpufrequency", &hz, &size, NULL, 0) == 0) {
+        return (int)(hz / 1000000);
+    }
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+// Utility function to get the kernel release, the result is cached in static storage
+static inline const char* _fossil_test_get_kernel(void) {
+    static char kernel[64] = {0};
+    if (kernel[0] != '\0') {
+        return kernel;
+    }
+#ifdef _WIN32
+    strncpy(kernel, "unknown", sizeof(kernel) - 1);
+#else
+    struct utsname buffer;
+    if (uname(&buffer) == 0) {
+        strncpy(kernel, buffer.release, sizeof(kernel) - 1);
+    } else {
+        strncpy(kernel, "unknown", sizeof(kernel) - 1);
+    }
+#endif
+    kernel[sizeof(kernel) - 1] = '\0';
+    return kernel;
+}
+
+// Utility function to get the 1, 5 and 15 minute load averages, false when unknown
+static inline bool _fossil_test_get_load_average(double load[3]) {
+#ifdef _WIN32
+    load[0] = load[1] = load[2] = 0.0;
+    return false;
+#else
+    return getloadavg(load, 3) == 3;
+#endif
+}
+
+// Utility function to get the cpufreq governor of the first CPU, empty when unknown
+static inline const char* _fossil_test_get_cpu_governor(void) {
+    static char governor[32] = {0};
+#if defined(__linux__)
+    if (governor[0] == '\0' &&
+        !_fossil_test_read_first_line("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor", governor, sizeof(governor))) {
+        governor[0] = '\0';
+    }
+#endif
+    return governor;
+}
+
+// Utility function to check for turbo boost: 1 when on, 0 when off, -1 when unknown
+static inline int _fossil_test_get_turbo(void) {
+#if defined(__linux__)
+    char line[16];
+    if (_fossil_test_read_first_line("/sys/devices/system/cpu/intel_pstate/no_turbo", line, sizeof(line))) {
+        return line[0] == '0' ? 1 : 0;
+    }
+    if (_fossil_test_read_first_line("/sys/devices/system/cpu/cpufreq/boost", line, sizeof(line))) {
+        return line[0] == '1' ? 1 : 0;
+    }
+#endif
+    return -1;
+}
+
+// Utility function to check for SMT: 1 when sibling threads are active, 0 when not, -1 when unknown
+static inline int _fossil_test_get_smt(void) {
+#if defined(__linux__)
+    char line[16];
+    if (_fossil_test_read_first_line("/sys/devices/system/cpu/smt/active", line, sizeof(line))) {
+        return line[0] == '1' ? 1 : 0;
+    }
+#endif
+    return -1;
+}
+
+// Utility function to list the SMT siblings of a CPU, such as "2,10", empty when unknown
+static inline bool _fossil_test_get_cpu_siblings(int cpu, char *siblings, size_t size) {
+    siblings[0] = '\0';
+#if defined(__linux__)
+    char path[96];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", cpu);
+    return _fossil_test_read_first_line(path, siblings, size);
+#else
+    (void)cpu;
+    (void)size;
+    return false;
+#endif
+}
+
+// Utility function to parse a cache size such as "48K", "2048K" or "32M" into bytes
+static inline size_t _fossil_test_parse_size(const char *text) {
+    char *end = NULL;
+    unsigned long long size = strtoull(text, &end, 10);
+    if (end != NULL && (*end == 'K' || *end == 'k')) {
+        size *= 1024ULL;
+    } else if (end != NULL && *end == 'M') {
+        size *= 1024ULL * 1024ULL;
+    } else if (end != NULL && *end == 'G') {
+        size *= 1024ULL * 1024ULL * 1024ULL;
+    }
+    return (size_t)size;
+}
+
+// Utility function to detect the caches of the first CPU: caches[0] is the cache line size,
+// caches[1] to caches[3] the L1 data, L2 and L3 sizes in bytes, 0 when unknown. The result is cached.
+static inline const size_t* _fossil_test_get_caches(void) {
+    static size_t caches[4] = {0, 0, 0, 0};
+    static bool probed = false;
+    if (probed) {
+        return caches;
+    }
+    probed = true;
+#if defined(__linux__)
+    for (int index = 0; index < 16; index++) {
+        char path[96];
+        char line[32];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+        if (!_fossil_test_read_first_line(path, line, sizeof(line))) {
+            break;
+        }
+        if (strcmp(line, "Instruction") == 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+        int level = _fossil_test_read_first_line(path, line, sizeof(line)) ? atoi(line) : 0;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+        if (level >= 1 && level <= 3 && _fossil_test_read_first_line(path, line, sizeof(line))) {
+            caches[level] = _fossil_test_parse_size(line);
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/coherency_line_size", index);
+        if (caches[0] == 0 && _fossil_test_read_first_line(path, line, sizeof(line))) {
+            caches[0] = (size_t)atoi(line);
+        }
+    }
+#elif defined(__APPLE__)
+    const char *names[4] = {"hw.cachelinesize", "hw.l1dcachesize", "hw.l2cachesize", "hw.l3cachesize"};
+    for (int level = 0; level < 4; level++) {
+        int64_t value = 0;
+        size_t size = sizeof(value);
+        if (sysctlbyname(names[level], &value, &size, NULL, 0) == 0 && value > 0) {
+            caches[level] = (size_t)value;
+        }
+    }
+#elif defined(_WIN32)
+    DWORD length = 0;
+    GetLogicalProcessorInformation(NULL, &length);
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION *info = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION*)malloc(length);
+    if (info != NULL && GetLogicalProcessorInformation(info, &length)) {
+        for (DWORD i = 0; i < length / sizeof(*info); i++) {
+            CACHE_DESCRIPTOR *cache = &info[i].Cache;
+            if (info[i].Relationship == RelationCache && cache->Type != CacheInstruction && cache->Level >= 1 && cache->Level <= 3) {
+                caches[cache->Level] = caches[cache->Level] > cache->Size ? caches[cache->Level] : cache->Size;
+                caches[0] = cache->LineSize;
+            }
+        }
+    }
+    free(info);
+#endif
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    // deterministic cache parameters (leaf 4) when the OS gave nothing
+    unsigned int eax, ebx, ecx, edx;
+    bool known = caches[1] != 0;
+    for (unsigned int index = 0; !known && index < 16 && __get_cpuid_count(4, index, &eax, &ebx, &ecx, &edx); index++) {
+        unsigned int type = eax & 0x1f;
+        unsigned int level = (eax >> 5) & 0x7;
+        if (type == 0) {
+            break;
+        }
+        if (type != 2 && level >= 1 && level <= 3) {
+            size_t line = (size_t)(ebx & 0xfff) + 1;
+            caches[level] = (size_t)(((ebx >> 22) & 0x3ff) + 1) * (size_t)(((ebx >> 12) & 0x3ff) + 1) * line * (size_t)(ecx + 1);
+            caches[0] = line;
+        }
+    }
+#endif
+    return caches;
+}
+
+// Utility function to get the size in bytes of the L1 data (1), L2 (2) or L3 (3) cache, 0 when unknown
+static inline size_t _fossil_test_get_cache_size(int level) {
+    return level >= 1 && level <= 3 ? _fossil_test_get_caches()[level] : 0;
+}
+
+// Utility function to get the cache line size in bytes, 64 when unknown
+static inline size_t _fossil_test_get_cache_line_size(void) {
+    size_t line = _fossil_test_get_caches()[0];
+    return line > 0 ? line : 64;
+}
+
 #ifdef __cplusplus
 }
 #endif
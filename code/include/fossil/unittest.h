@@ -19,6 +19,11 @@ extern "C"
 #endif
 
 #include "unittest/benchmark.h" // benchmarking functionaility
+#include "unittest/scaling.h"
+#include "unittest/workingset.h"
+#include "unittest/cold.h"
+#include "unittest/startup.h"
+#include "unittest/trace.h"
 #include "unittest/internal.h" // internal header file for fossil test
 #include "unittest/console.h"
 
@@ -387,154 +392,451 @@ extern "C"
 // Bench specific commands
 // =================================================================
 
+/**
+ * @brief Define macro for a statistical micro-benchmark.
+ *
+ * The body receives `fossil_bench_t *bench` and is sampled many times: the
+ * harness calibrates the number of iterations per sample, warms up, then
+ * reports min, median, mean, MAD and p99 with outliers rejected. The result
+ * is a test case tagged "performance" that is added with ADD_TEST.
+ *
+ * Example:
+ * @code
+ * FOSSIL_BENCH(sort_small) {
+ *     FOSSIL_BENCH_LOOP(bench) {
+ *         insertion_sort(data, size);
+ *     }
+ * }
+ * @endcode
+ *
+ * @param name The name of the benchmark.
+ */
+#define FOSSIL_BENCH(name) _FOSSIL_BENCH(name)
+
+/**
+ * @brief Define macro for a benchmark over a range of input sizes.
+ *
+ * The body runs for every size from first to last, multiplying by factor, and
+ * reads the size from `bench->arg`. Data for the size is generated before
+ * FOSSIL_BENCH_LOOP so it is not timed. Every size is reported as "name/size",
+ * then the medians are fitted to O(1), O(log n), O(n), O(n log n) and O(n^2).
+ *
+ * Example:
+ * @code
+ * FOSSIL_BENCH_RANGE(sort_sweep, 16, 1 << 24, 4) {
+ *     int *data = make_random_array(bench->arg);
+ *     FOSSIL_BENCH_LOOP(bench) {
+ *         insertion_sort(data, bench->arg);
+ *     }
+ *     free(data);
+ * }
+ * @endcode
+ *
+ * @param name The name of the benchmark.
+ * @param first The first input size.
+ * @param last The last input size.
+ * @param factor The factor between two sizes, at least 2.
+ */
+#define FOSSIL_BENCH_RANGE(name, first, last, factor) _FOSSIL_BENCH_RANGE(name, first, last, factor)
+
+/**
+ * @brief Define macro for a benchmark that compares implementations head to head.
+ *
+ * The body runs the implementation picked by `bench->variant` on the same
+ * input for every variant. Samples of the variants are interleaved, one per
+ * variant each round in a shuffled order, and the report gives the speedup of
+ * every variant over the first with its 95% confidence interval.
+ *
+ * @code
+ * static const char *const sorts[] = { "bubble", "insertion" };
+ *
+ * FOSSIL_BENCH_AB(sort_ab, sorts) {
+ *     FOSSIL_BENCH_LOOP(bench) {
+ *         memcpy(data, input, sizeof(input));
+ *         if (bench->variant == 0) {
+ *             bubble_sort(data, size);
+ *         } else {
+ *             insertion_sort(data, size);
+ *         }
+ *     }
+ * }
+ * @endcode
+ *
+ * @param name The name of the benchmark.
+ * @param variants A static array with the name of every implementation, the first is the reference.
+ */
+#define FOSSIL_BENCH_AB(name, variants) _FOSSIL_BENCH_AB(name, variants)
+
+/**
+ * @brief Define macro for the timed loop inside a FOSSIL_BENCH body.
+ *
+ * Everything before the loop is setup and is not timed. Bodies without the
+ * loop are timed as a whole, once per iteration.
+ *
+ * @param bench The benchmark handle passed to the body.
+ */
+#define FOSSIL_BENCH_LOOP(bench) _FOSSIL_BENCH_LOOP(bench)
+
+/**
+ * @brief Define macro to record the latency of every iteration of FOSSIL_BENCH_LOOP.
+ *
+ * Call it once in the body before the loop. The clock is then read between two
+ * iterations, so use it for operations well above the clock overhead. The
+ * percentiles up to p99.999 are reported next to the benchmark and in the
+ * summary, and `bench-histogram <file>` writes the histograms out.
+ *
+ * @param bench The benchmark handle.
+ */
+#define FOSSIL_BENCH_RECORD_LATENCY(bench) _FOSSIL_BENCH_RECORD_LATENCY(bench)
+
+/**
+ * @brief Define macro to record the latency of one operation timed by the body,
+ * for example with a fossil_bench_timer_t lap.
+ *
+ * @param bench The benchmark handle.
+ * @param ns The latency in nanoseconds.
+ */
+#define FOSSIL_BENCH_RECORD(bench, ns) _FOSSIL_BENCH_RECORD(bench, ns)
+
+/**
+ * @brief Define macro to keep the result of benchmarked work alive.
+ *
+ * Without it the compiler may delete work whose result is never used, or hoist
+ * it out of the timed loop, and report 0 ns. The value must be a variable or
+ * another lvalue; it is forced to memory and treated as read at this point.
+ *
+ * @param value The variable holding the result.
+ */
+#define FOSSIL_BENCH_DO_NOT_OPTIMIZE(value) _FOSSIL_BENCH_DO_NOT_OPTIMIZE(value)
+
+/**
+ * @brief Define macro to make the compiler treat all memory as read and written.
+ *
+ * Stores before it are kept and loads after it are redone. FOSSIL_BENCH_LOOP
+ * already does this between iterations.
+ */
+#define FOSSIL_BENCH_CLOBBER_MEMORY() _FOSSIL_BENCH_CLOBBER_MEMORY()
+
+/**
+ * @brief Define macro for a benchmark that measures scaling across threads.
+ *
+ * The body runs on 1, 2, 4 and so on up to the number of CPUs, or the
+ * `bench-threads` option, with every thread starting its FOSSIL_BENCH_LOOP
+ * at the same time. The body reads `bench->thread_index` and
+ * `bench->thread_count`. The report is a table of aggregate throughput,
+ * latency per thread and parallel efficiency for every thread count.
+ *
+ * @param name The name of the benchmark.
+ */
+#define FOSSIL_BENCH_THREADS(name) _FOSSIL_BENCH_THREADS(name)
+
+/**
+ * @brief Define macro for a benchmark over working sets around every cache level.
+ *
+ * The L1 data, L2 and L3 sizes of the host are detected at run time, and the
+ * body is sampled on a working set of three quarters and of twice every
+ * level. The body gets the size in `bench->arg` and a line aligned buffer in
+ * `bench->working_set`, laid out as a random cycle through its cache lines
+ * that FOSSIL_BENCH_WORKING_SET_CHASE follows. The report shows the slowdown
+ * once the working set no longer fits each level.
+ *
+ * @param name The name of the benchmark.
+ */
+#define FOSSIL_BENCH_WORKING_SET(name) _FOSSIL_BENCH_WORKING_SET(name)
+
+/**
+ * @brief Define macro to follow the cycle of a working set buffer.
+ *
+ * @param start The line to start from, `bench->working_set` to begin with.
+ * @param steps The number of cache lines to visit.
+ */
+#define FOSSIL_BENCH_WORKING_SET_CHASE(start, steps) fossil_bench_working_set_chase(start, steps)
+
+/**
+ * @brief Define macro for a benchmark of how long a command takes to start.
+ *
+ * Every sample forks and execs the command, looked up in PATH, and times it
+ * until it exits or, with a marker, until the marker shows up on its standard
+ * output, after which it is killed untimed along with its process group. A
+ * start that takes longer than 30 seconds is killed and fails the benchmark.
+ * Every start is one sample, so the usual statistics, baselines and
+ * bench-compare gate apply. Ends with a
+ * semicolon, there is no body.
+ *
+ * @code
+ * FOSSIL_BENCH_STARTUP(tool_help, xnull, "./tool", "--help");
+ * FOSSIL_BENCH_STARTUP(server_ready, "listening", "./server", "--port", "0");
+ * @endcode
+ *
+ * @param name The name of the benchmark.
+ * @param marker Text the command writes once it is ready, xnull to time it to its exit.
+ * @param ... The command and its arguments.
+ */
+#define FOSSIL_BENCH_STARTUP(name, marker, ...) _FOSSIL_BENCH_STARTUP(name, marker, __VA_ARGS__)
+
+/**
+ * @brief Define macro for a benchmark of a cold start of code in this program.
+ *
+ * The body is an entry point returning an exit status. Every sample forks a
+ * fresh child that runs it, timed until the child exits or the body calls
+ * FOSSIL_BENCH_READY. Not supported on Windows.
+ *
+ * @param name The name of the benchmark.
+ */
+#define FOSSIL_BENCH_ENTRY(name) _FOSSIL_BENCH_ENTRY(name)
+
+/**
+ * @brief Define macro for the entry point of a FOSSIL_BENCH_ENTRY to end the sample.
+ */
+#define FOSSIL_BENCH_READY() _FOSSIL_BENCH_READY()
+
+/**
+ * @brief Define macros to declare what one iteration of a benchmark processes.
+ *
+ * Called in the body before FOSSIL_BENCH_LOOP. The harness then reports the
+ * throughput, in bytes or items per second, over the same samples as the
+ * timings, and keeps it in saved baselines.
+ *
+ * @param bench The benchmark handle passed to the body.
+ * @param count Bytes or items processed by one iteration.
+ */
+#define FOSSIL_BENCH_SET_BYTES(bench, count) _FOSSIL_BENCH_SET_BYTES(bench, count)
+#define FOSSIL_BENCH_SET_ITEMS(bench, count) _FOSSIL_BENCH_SET_ITEMS(bench, count)
+
+/**
+ * @brief Define macros to leave part of an iteration out of the timing.
+ *
+ * Called inside the iteration, for work such as restoring an input the
+ * iteration mutates. The overhead of the clock reads is subtracted from every
+ * timed stretch, a pause still costs a few nanoseconds the clock cannot see,
+ * so keep the timed part well above that.
+ *
+ * @param bench The benchmark handle passed to the body.
+ */
+#define FOSSIL_BENCH_PAUSE(bench) _FOSSIL_BENCH_PAUSE(bench)
+#define FOSSIL_BENCH_RESUME(bench) _FOSSIL_BENCH_RESUME(bench)
+
+/**
+ * @brief Define macro to set up every iteration of a benchmark untimed.
+ *
+ * Called in the body before FOSSIL_BENCH_LOOP. The function runs before every
+ * iteration with the timer paused, the same as wrapping it in
+ * FOSSIL_BENCH_PAUSE and FOSSIL_BENCH_RESUME.
+ *
+ * @code
+ * static void shuffle(fossil_bench_t *bench) {
+ *     memcpy(data, input, sizeof(input));
+ * }
+ *
+ * FOSSIL_BENCH(sort_in_place) {
+ *     FOSSIL_BENCH_SETUP_ITERATION(bench, shuffle);
+ *     FOSSIL_BENCH_LOOP(bench) {
+ *         insertion_sort(data, size);
+ *     }
+ * }
+ * @endcode
+ *
+ * @param bench The benchmark handle passed to the body.
+ * @param function The setup, it takes the benchmark handle.
+ */
+#define FOSSIL_BENCH_SETUP_ITERATION(bench, function) _FOSSIL_BENCH_SETUP_ITERATION(bench, function)
+
+/**
+ * @brief Define macros to sample a benchmark cold as well as warm.
+ *
+ * Called in the body. After the warm samples as many cold samples are taken,
+ * one iteration each. Before every cold sample FOSSIL_BENCH_COLD reads through
+ * a buffer larger than all cache levels, FOSSIL_BENCH_COLD_RANGE flushes only
+ * the given range, which is much faster, and FOSSIL_BENCH_COLD_BRANCHES also
+ * disturbs the branch predictors. Cold and warm medians are reported side by
+ * side. The bench-cold option does the same for every benchmark.
+ *
+ * @param bench The benchmark handle passed to the body.
+ * @param data The start of the data the body works on.
+ * @param size The size of that data in bytes.
+ */
+#define FOSSIL_BENCH_COLD(bench) _FOSSIL_BENCH_COLD(bench)
+#define FOSSIL_BENCH_COLD_RANGE(bench, data, size) _FOSSIL_BENCH_COLD_RANGE(bench, data, size)
+#define FOSSIL_BENCH_COLD_BRANCHES(bench) _FOSSIL_BENCH_COLD_BRANCHES(bench)
+
+/**
+ * @brief Define macro to limit the heap allocations of a benchmark.
+ *
+ * Called in the body before FOSSIL_BENCH_LOOP. Once sampled, the benchmark
+ * fails when its timed region made more allocations per iteration than the
+ * limit. Only checked when the allocator is hooked, see `allocs`.
+ *
+ * @param bench The benchmark handle passed to the body.
+ * @param limit The most allocations allowed per iteration, 0 for none.
+ */
+#define FOSSIL_BENCH_EXPECT_ALLOCS(bench, limit) _FOSSIL_BENCH_EXPECT_ALLOCS(bench, limit)
+
 /**
  * @brief Define macro for starting a benchmark.
  * 
- * This macro is used to mark the start of a benchmark. It typically initializes
- * any necessary resources or variables required for benchmarking.
+ * This macro (re)starts the benchmark timer of the calling thread. It is an
+ * expression, so it can be used as often as needed and anywhere a call can.
+ * Benchmarks that nest or overlap use a fossil_bench_timer_t of their own.
  */
 #define TEST_BENCHMARK() fossil_test_start_benchmark()
 
 /**
  * @brief Define macro for getting the current time.
  * 
- * This macro is used to retrieve the current time, which is typically used
- * in conjunction with TEST_BENCHMARK to calculate the elapsed time for a benchmark.
+ * This macro is used to retrieve the time elapsed in nanoseconds since the
+ * last TEST_BENCHMARK of the calling thread, without stopping its timer.
+ */
+#define TEST_CURRENT_TIME() fossil_test_elapsed_benchmark()
+
+/**
+ * @brief Define macro for counting heap allocations.
+ *
+ * This macro declares an allocation scope local to the enclosing block and
+ * begins it. Pair it with TEST_ALLOCS_ENDED() to assert on what was allocated.
+ */
+#define TEST_ALLOCS() fossil_test_allocs_t _fossil_test_allocs; fossil_test_allocs_begin(&_fossil_test_allocs)
+
+/**
+ * @brief Define macro for ending the allocation scope of TEST_ALLOCS().
+ *
+ * This macro ends the scope and yields the number of allocations made since
+ * it began, for example ASSUME_ITS_EQUAL_U64(TEST_ALLOCS_ENDED(), 0). The
+ * count is always 0 when the allocator is not hooked.
  */
-#define TEST_CURRENT_TIME() fossil_test_stop_benchmark()
+#define TEST_ALLOCS_ENDED() (fossil_test_allocs_end(&_fossil_test_allocs), _fossil_test_allocs.allocs)
 
 /**
  * @brief Define macro for reporting test duration with a given timeout.
  * 
  * This macro is used to report the duration of a test with a given timeout.
- * It takes the timeout duration, elapsed time, and actual duration as arguments
- * and reports the results, typically in the form of logs or console output.
+ * It takes the unit, the elapsed time and the limit as arguments and reports
+ * the benchmark when it went over the limit.
  * 
  * @param duration The duration unit (e.g., "minutes", "seconds").
- * @param elapsed The elapsed time since the benchmark started.
- * @param actual The actual duration of the test.
+ * @param elapsed The elapsed time in nanoseconds, usually TEST_CURRENT_TIME().
+ * @param limit The time limit in the given unit.
  */
-#define TEST_DURATION(duration, elapsed, actual) fossil_test_benchmark((char*)duration, elapsed, actual)
+#define TEST_DURATION(duration, elapsed, limit) fossil_test_benchmark((char*)duration, elapsed, limit)
 
 /**
  * @brief Define macro for reporting test duration in minutes.
  * 
  * This macro is a shorthand for reporting test duration in minutes using TEST_DURATION.
- * It takes the elapsed time and actual duration as arguments and reports the results
+ * It takes the elapsed time and the limit as arguments and reports the results
  * in minutes.
  * 
- * @param elapsed The elapsed time since the benchmark started.
- * @param actual The actual duration of the test.
+ * @param elapsed The elapsed time in nanoseconds, usually TEST_CURRENT_TIME().
+ * @param limit The time limit in the given unit.
  */
-#define TEST_DURATION_MIN(elapsed, actual) TEST_DURATION((char*)"minutes", elapsed, actual)
+#define TEST_DURATION_MIN(elapsed, limit) TEST_DURATION((char*)"minutes", elapsed, limit)
 
 /**
  * @brief Define macro for reporting test duration in seconds.
  * 
  * This macro is a shorthand for reporting test duration in seconds using TEST_DURATION.
- * It takes the elapsed time and actual duration as arguments and reports the results
+ * It takes the elapsed time and the limit as arguments and reports the results
  * in seconds.
  * 
- * @param elapsed The elapsed time since the benchmark started.
- * @param actual The actual duration of the test.
+ * @param elapsed The elapsed time in nanoseconds, usually TEST_CURRENT_TIME().
+ * @param limit The time limit in the given unit.
  */
-#define TEST_DURATION_SEC(elapsed, actual) TEST_DURATION((char*)"seconds", elapsed, actual)
+#define TEST_DURATION_SEC(elapsed, limit) TEST_DURATION((char*)"seconds", elapsed, limit)
 
 /**
  * @brief Define macro for reporting test duration in milliseconds.
  * 
  * This macro is a shorthand for reporting test duration in milliseconds using TEST_DURATION.
- * It takes the elapsed time and actual duration as arguments and reports the results
+ * It takes the elapsed time and the limit as arguments and reports the results
  * in milliseconds.
  * 
- * @param elapsed The elapsed time since the benchmark started.
- * @param actual The actual duration of the test.
+ * @param elapsed The elapsed time in nanoseconds, usually TEST_CURRENT_TIME().
+ * @param limit The time limit in the given unit.
  */
-#define TEST_DURATION_MIL(elapsed, actual) TEST_DURATION((char*)"milliseconds", elapsed, actual)
+#define TEST_DURATION_MIL(elapsed, limit) TEST_DURATION((char*)"milliseconds", elapsed, limit)
 
 /**
  * @brief Define macro for reporting test duration in microseconds.
  * 
  * This macro is a shorthand for reporting test duration in microseconds using TEST_DURATION.
- * It takes the elapsed time and actual duration as arguments and reports the results
+ * It takes the elapsed time and the limit as arguments and reports the results
  * in microseconds.
  * 
- * @param elapsed The elapsed time since the benchmark started.
- * @param actual The actual duration of the test.
+ * @param elapsed The elapsed time in nanoseconds, usually TEST_CURRENT_TIME().
+ * @param limit The time limit in the given unit.
  */
-#define TEST_DURATION_MIC(elapsed, actual) TEST_DURATION((char*)"microseconds", elapsed, actual)
+#define TEST_DURATION_MIC(elapsed, limit) TEST_DURATION((char*)"microseconds", elapsed, limit)
 
 /**
  * @brief Define macro for reporting test duration in nanoseconds.
  * 
  * This macro is a shorthand for reporting test duration in nanoseconds using TEST_DURATION.
- * It takes the elapsed time and actual duration as arguments and reports the results
+ * It takes the elapsed time and the limit as arguments and reports the results
  * in nanoseconds.
  * 
- * @param elapsed The elapsed time since the benchmark started.
- * @param actual The actual duration of the test.
+ * @param elapsed The elapsed time in nanoseconds, usually TEST_CURRENT_TIME().
+ * @param limit The time limit in the given unit.
  */
-#define TEST_DURATION_NAN(elapsed, actual) TEST_DURATION((char*)"nanoseconds", elapsed, actual)
+#define TEST_DURATION_NAN(elapsed, limit) TEST_DURATION((char*)"nanoseconds", elapsed, limit)
 
 /**
  * @brief Define macro for reporting test duration in picoseconds.
  * 
  * This macro is a shorthand for reporting test duration in picoseconds using TEST_DURATION.
- * It takes the elapsed time and actual duration as arguments and reports the results
+ * It takes the elapsed time and the limit as arguments and reports the results
  * in picoseconds.
  * 
- * @param elapsed The elapsed time since the benchmark started.
- * @param actual The actual duration of the test.
+ * @param elapsed The elapsed time in nanoseconds, usually TEST_CURRENT_TIME().
+ * @param limit The time limit in the given unit.
  */
-#define TEST_DURATION_PIC(elapsed, actual) TEST_DURATION((char*)"picoseconds", elapsed, actual)
+#define TEST_DURATION_PIC(elapsed, limit) TEST_DURATION((char*)"picoseconds", elapsed, limit)
 
 /**
  * @brief Define macro for reporting test duration in femtoseconds.
  * 
  * This macro is a shorthand for reporting test duration in femtoseconds using TEST_DURATION.
- * It takes the elapsed time and actual duration as arguments and reports the results
+ * It takes the elapsed time and the limit as arguments and reports the results
  * in femtoseconds.
  * 
- * @param elapsed The elapsed time since the benchmark started.
- * @param actual The actual duration of the test.
+ * @param elapsed The elapsed time in nanoseconds, usually TEST_CURRENT_TIME().
+ * @param limit The time limit in the given unit.
  */
-#define TEST_DURATION_FEM(elapsed, actual) TEST_DURATION((char*)"femtoseconds", elapsed, actual)
+#define TEST_DURATION_FEM(elapsed, limit) TEST_DURATION((char*)"femtoseconds", elapsed, limit)
 
 /**
  * @brief Define macro for reporting test duration in attoseconds.
  * 
  * This macro is a shorthand for reporting test duration in attoseconds using TEST_DURATION.
- * It takes the elapsed time and actual duration as arguments and reports the results
+ * It takes the elapsed time and the limit as arguments and reports the results
  * in attoseconds.
  * 
- * @param elapsed The elapsed time since the benchmark started.
- * @param actual The actual duration of the test.
+ * @param elapsed The elapsed time in nanoseconds, usually TEST_CURRENT_TIME().
+ * @param limit The time limit in the given unit.
  */
-#define TEST_DURATION_ATT(elapsed, actual) TEST_DURATION((char*)"attoseconds", elapsed, actual)
+#define TEST_DURATION_ATT(elapsed, limit) TEST_DURATION((char*)"attoseconds", elapsed, limit)
 
 /**
  * @brief Define macro for reporting test duration in zeptoseconds.
  * 
  * This macro is a shorthand for reporting test duration in zeptoseconds using TEST_DURATION.
- * It takes the elapsed time and actual duration as arguments and reports the results
+ * It takes the elapsed time and the limit as arguments and reports the results
  * in zeptoseconds.
  * 
- * @param elapsed The elapsed time since the benchmark started.
- * @param actual The actual duration of the test.
+ * @param elapsed The elapsed time in nanoseconds, usually TEST_CURRENT_TIME().
+ * @param limit The time limit in the given unit.
  */
-#define TEST_DURATION_ZEP(elapsed, actual) TEST_DURATION((char*)"zeptoseconds", elapsed, actual)
+#define TEST_DURATION_ZEP(elapsed, limit) TEST_DURATION((char*)"zeptoseconds", elapsed, limit)
 
 /**
  * @brief Define macro for reporting test duration in yoctoseconds.
  * 
  * This macro is a shorthand for reporting test duration in yoctoseconds using TEST_DURATION.
- * It takes the elapsed time and actual duration as arguments and reports the results
+ * It takes the elapsed time and the limit as arguments and reports the results
  * in yoctoseconds.
  * 
- * @param elapsed The elapsed time since the benchmark started.
- * @param actual The actual duration of the test.
+ * @param elapsed The elapsed time in nanoseconds, usually TEST_CURRENT_TIME().
+ * @param limit The time limit in the given unit.
  */
-#define TEST_DURATION_YOC(elapsed, actual) TEST_DURATION((char*)"yoctoseconds", elapsed, actual)
+#define TEST_DURATION_YOC(elapsed, limit) TEST_DURATION((char*)"yoctoseconds", elapsed, limit)
 
 
 // =================================================================
@@ -0,0 +1,100 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FOSSIL_TEST_ALLOCS_H
+#define FOSSIL_TEST_ALLOCS_H
+
+#include "fossil/_common/common.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Heap allocations counted around benchmark samples, and around whole test
+ * cases when the `allocs` option is enabled. Counting needs the separate
+ * fossil-test-allochook library (the `alloc_hooks` option, glibc only), which
+ * replaces malloc, calloc, realloc, reallocarray, free and the aligned
+ * allocators with thin wrappers over the C library allocator. Nothing is
+ * wrapped in a program that neither links nor LD_PRELOADs it, and then every
+ * scope reports as not counted. The wrappers only count while a scope is open.
+ */
+typedef struct {
+    bool valid;              /**< The allocator is hooked and the scope was counted. */
+    bool open;               /**< The scope has begun and not yet ended. */
+    uint64_t allocs;         /**< Calls to malloc, calloc and realloc that returned memory. */
+    uint64_t frees;          /**< Blocks released with free or realloc. */
+    uint64_t bytes;          /**< Bytes requested by those calls. */
+    int64_t peak_bytes;      /**< Highest live heap above the level at the start of the scope. */
+    uint64_t begin_allocs;   /**< Allocation count when the scope began. */
+    uint64_t begin_frees;    /**< Free count when the scope began. */
+    uint64_t begin_bytes;    /**< Requested bytes when the scope began. */
+    int64_t begin_live;      /**< Live bytes when the scope began. */
+} fossil_test_allocs_t;
+
+/**
+ * Totals kept by the fossil-test-allochook library since the program started.
+ */
+typedef struct {
+    uint64_t allocs; /**< Allocations that returned memory. */
+    uint64_t frees;  /**< Blocks released. */
+    uint64_t bytes;  /**< Bytes requested. */
+    int64_t live;    /**< Usable bytes of the blocks counted as live. */
+    int64_t peak;    /**< Highest live bytes since the last reset. */
+} fossil_test_allochook_totals_t;
+
+/**
+ * Entry points of the fossil-test-allochook library. The hooks only count
+ * while at least one scope is open.
+ */
+void fossil_test_allochook_scope(int32_t delta);
+void fossil_test_allochook_reset_peak(void);
+void fossil_test_allochook_read(fossil_test_allochook_totals_t *totals);
+
+/**
+ * Function to tell whether allocations can be counted in this program.
+ *
+ * @return True when the allocator is hooked.
+ */
+bool fossil_test_allocs_available(void);
+
+/**
+ * Function to start counting allocations. Scopes may overlap, but the peak
+ * is only meaningful for the innermost one.
+ *
+ * @param scope The scope to begin.
+ */
+void fossil_test_allocs_begin(fossil_test_allocs_t *scope);
+
+/**
+ * Function to stop counting and store what happened since the scope began.
+ * Ending a scope that is not open leaves it unchanged.
+ *
+ * @param scope The scope to end.
+ */
+void fossil_test_allocs_end(fossil_test_allocs_t *scope);
+
+/**
+ * Function to add an ended scope to a running total, the peak is the highest
+ * of the two.
+ *
+ * @param total The total to add to.
+ * @param scope The scope that ended.
+ */
+void fossil_test_allocs_accumulate(fossil_test_allocs_t *total, const fossil_test_allocs_t *scope);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
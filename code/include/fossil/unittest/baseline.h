@@ -0,0 +1,161 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FOSSIL_TEST_BASELINE_H
+#define FOSSIL_TEST_BASELINE_H
+
+#include "fossil/_common/common.h"
+#include "fossil/unittest/benchmark.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+enum {
+    FOSSIL_BENCH_NAME_MAX = 128 // longest benchmark name kept in a baseline
+};
+
+/**
+ * Structure representing one benchmark read back from a baseline file.
+ *
+ * Baseline files are plain text. The first line is "fossil-bench 1", then one
+ * line per benchmark holding "bench <name>", key and value pairs such as
+ * "iterations <n>", "allocs <per iteration>" or "processed_bytes <per
+ * iteration>" with its median "bytes_per_second", and finally "samples <count>" followed by the nanoseconds
+ * per iteration of every sample. Unknown lines and keys are skipped.
+ */
+typedef struct fossil_bench_record_t fossil_bench_record_t;
+struct fossil_bench_record_t {
+    char name[FOSSIL_BENCH_NAME_MAX];         /**< Name of the benchmark. */
+    uint64_t iterations;                      /**< Iterations per sample. */
+    uint64_t processed_bytes;                 /**< Bytes processed per iteration, 0 when not declared. */
+    uint64_t processed_items;                 /**< Items processed per iteration, 0 when not declared. */
+    bool has_allocs;                          /**< Allocations were counted for this benchmark. */
+    double allocs;                            /**< Allocations per iteration. */
+    double bytes;                             /**< Bytes allocated per iteration. */
+    int32_t sample_count;                     /**< Number of samples. */
+    double samples[FOSSIL_BENCH_MAX_SAMPLES]; /**< Nanoseconds per iteration of every sample. */
+    fossil_bench_record_t *next;              /**< Next benchmark of the file. */
+};
+
+/**
+ * Function to write the samples of every benchmark that ran to a baseline file.
+ *
+ * @param path The file to write.
+ * @param benches The benchmarks that ran, in run order.
+ * @return True when the file was written.
+ */
+bool fossil_bench_save(const char *path, const fossil_bench_t *benches);
+
+/**
+ * Function to read a baseline file.
+ *
+ * @param path The file to read.
+ * @param arena The arena the records are allocated from.
+ * @param ok Set to false when the file could not be read or is not a baseline.
+ * @return The records in file order, xnull when there are none.
+ */
+fossil_bench_record_t *fossil_bench_load(const char *path, fossil_test_arena_t *arena, bool *ok);
+
+/**
+ * Function to find a benchmark by name in loaded records.
+ *
+ * @param records The records to search.
+ * @param name The name of the benchmark.
+ * @return The record, or xnull when it is not in the baseline.
+ */
+const fossil_bench_record_t *fossil_bench_find(const fossil_bench_record_t *records, const char *name);
+
+/**
+ * Function to estimate how long a benchmark case took when a baseline was saved,
+ * from the samples of the benchmark and of its variants named "<name>/...".
+ * @param records The records to search.
+ * @param name The name of the benchmark case.
+ * @return The sampled time in nanoseconds, 0 when the baseline does not have it.
+ */
+uint64_t fossil_bench_history_ns(const fossil_bench_record_t *records, const char *name);
+
+/**
+ * Function to get the benchmarks of an earlier run: the baseline given with
+ * `bench-compare`, or else the previous run still in the `bench-save` file.
+ * The file is read on first use.
+ * @return The records, xnull when there is no earlier run.
+ */
+const fossil_bench_record_t *fossil_bench_history(void);
+
+/**
+ * Function to run a two sided Mann-Whitney U test between two sets of samples,
+ * with the normal approximation and a correction for ties.
+ *
+ * @param baseline The baseline samples.
+ * @param baseline_count The number of baseline samples.
+ * @param current The current samples.
+ * @param current_count The number of current samples.
+ * @param z Set to the z-score, positive when the current samples are larger.
+ * @return The p-value, 1 when either set is empty or all values tie.
+ */
+double fossil_bench_mann_whitney(const double *baseline, int32_t baseline_count, const double *current, int32_t current_count, double *z);
+
+/**
+ * Function to compare samples against their baseline. The change is the
+ * Hodges-Lehmann shift, the median difference over every pair of samples,
+ * so it always lies inside its confidence interval.
+ *
+ * @param baseline The baseline samples.
+ * @param baseline_count The number of baseline samples.
+ * @param current The current samples.
+ * @param current_count The number of current samples.
+ * @param threshold Relative change that counts, 0.05 for 5%.
+ * @param compare The comparison to fill in.
+ */
+void fossil_bench_compare(const double *baseline, int32_t baseline_count, const double *current, int32_t current_count,
+    double threshold, fossil_bench_compare_t *compare);
+
+/**
+ * Structure holding one row of a comparison between two baseline files.
+ */
+typedef struct {
+    const char *name;                    /**< Name of the benchmark. */
+    const fossil_bench_record_t *before; /**< Record in the old file, xnull when the benchmark was added. */
+    const fossil_bench_record_t *after;  /**< Record in the new file, xnull when the benchmark was removed. */
+    double before_median_ns;             /**< Median of the old samples, 0 when there are none. */
+    double after_median_ns;              /**< Median of the new samples, 0 when there are none. */
+    fossil_bench_compare_t compare;      /**< Comparison of the two, verdict none unless both files have it. */
+} fossil_bench_report_row_t;
+
+/**
+ * Function to compare two baseline files written with `bench-save` and print
+ * a report sorted by the size of the change, nothing is rebuilt or run. The
+ * threshold is taken from `bench-threshold`.
+ *
+ * @param old_path The baseline of the old run.
+ * @param new_path The baseline of the new run.
+ * @param json Print the report as JSON instead of a table.
+ * @return 0 when nothing got slower, 1 when a benchmark got slower, 2 when a file could not be read.
+ */
+int fossil_bench_report(const char *old_path, const char *new_path, bool json);
+
+/**
+ * Function to compare a benchmark that just ran against the baseline given
+ * with `bench-compare`, and fail it when it got significantly slower than the
+ * threshold allows. The baseline file is read on first use.
+ *
+ * @param bench The benchmark that just ran.
+ */
+void fossil_bench_gate(fossil_bench_t *bench);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
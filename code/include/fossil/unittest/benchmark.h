@@ -14,33 +14,734 @@ Description:
 #define FOSSIL_TEST_BENCHMARK_H
 
 #include "fossil/_common/common.h"
+#include "fossil/unittest/internal.h"
+#include "fossil/unittest/counters.h"
+#include "fossil/unittest/allocs.h"
+#include "fossil/unittest/histogram.h"
+
+// Cycle counters the benchmark clock can read directly
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FOSSIL_BENCH_CYCLES_X86 1
+#elif defined(_M_X64) && defined(_MSC_VER)
+#define FOSSIL_BENCH_CYCLES_X86 1
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define FOSSIL_BENCH_CYCLES_ARM64 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h> // __rdtsc and _ReadWriteBarrier
+#endif
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+// Defaults for the statistical benchmark harness
+enum {
+    FOSSIL_BENCH_MAX_SAMPLES = 128,      // capacity of the per benchmark sample array
+    FOSSIL_BENCH_SAMPLES     = 30,       // samples collected after warmup
+    FOSSIL_BENCH_SAMPLE_NS   = 2000000,  // calibration target for one sample (2 ms)
+    FOSSIL_BENCH_WARMUP_NS   = 10000000, // time spent warming up before sampling (10 ms)
+    FOSSIL_BENCH_MAX_POINTS  = 32,       // sizes a range benchmark can sweep over
+    FOSSIL_BENCH_AB_VARIANTS = 8         // implementations an A/B benchmark can interleave
+};
+
+typedef void (*fossil_bench_function_t)(fossil_bench_t *bench);
+
+/**
+ * Structure describing the clock behind the benchmark timers. On x86-64 with an
+ * invariant TSC and on AArch64 the timers read the cycle counter, which costs a
+ * few nanoseconds instead of the 20-30 of clock_gettime. The tick rate is
+ * calibrated against the monotonic clock, and the cost of one start and stop
+ * pair is measured so it can be subtracted from every timed stretch.
+ */
+typedef struct {
+    bool calibrated;         /**< The clock has been calibrated. */
+    bool cycles;             /**< Ticks come from the cycle counter, otherwise they are monotonic ns. */
+    bool rdtscp;             /**< The end of a stretch is read with RDTSCP. */
+    double ns_per_tick;      /**< Nanoseconds per tick. */
+    uint64_t overhead_ticks; /**< Cost of one start and stop pair, in ticks. */
+    const char *source;      /**< Name of the counter in use, for reports. */
+} fossil_bench_clock_t;
+
+extern fossil_bench_clock_t _BENCH_CLOCK;
+
+/**
+ * Structure representing a benchmark timer. Each timer is its own handle with
+ * no shared state, so timers can be nested, used inside timed fixtures and run
+ * on several threads at once. Times are kept in ticks of the benchmark clock.
+ */
+typedef struct {
+    uint64_t started; /**< Tick when the timer was last started or resumed, or paused while it is not running. */
+    uint64_t elapsed; /**< Ticks accumulated before the last pause. */
+    uint64_t lap;     /**< Elapsed ticks at the last lap. */
+    bool running;     /**< The timer is counting. */
+} fossil_bench_timer_t;
+
+/**
+ * Structure holding the statistics of a benchmark, all times are per iteration.
+ * Outliers are rejected with the modified z-score (|x - median| / MAD) before
+ * everything but the outlier count is computed.
+ */
+typedef struct {
+    double min_ns;    /**< Fastest sample. */
+    double median_ns; /**< Median sample. */
+    double mean_ns;   /**< Arithmetic mean of the samples. */
+    double mad_ns;    /**< Median absolute deviation from the median. */
+    double p99_ns;    /**< 99th percentile sample. */
+    double max_ns;    /**< Slowest sample. */
+    int32_t samples;  /**< Number of samples kept. */
+    int32_t outliers; /**< Number of samples rejected as outliers. */
+} fossil_bench_stats_t;
+
+/**
+ * Verdict of comparing a benchmark against its baseline.
+ */
+typedef enum {
+    FOSSIL_BENCH_VERDICT_NONE,   /**< No baseline for this benchmark. */
+    FOSSIL_BENCH_VERDICT_SAME,   /**< No significant change beyond the threshold. */
+    FOSSIL_BENCH_VERDICT_FASTER, /**< Significantly faster than the baseline. */
+    FOSSIL_BENCH_VERDICT_SLOWER  /**< Significantly slower than the baseline. */
+} fossil_bench_verdict_t;
+
+/**
+ * Structure holding the comparison of a benchmark against its baseline.
+ */
+typedef struct {
+    fossil_bench_verdict_t verdict; /**< Outcome of the comparison. */
+    double baseline_median_ns;      /**< Median of the baseline samples. */
+    double delta;                   /**< Median shift of the samples against the baseline median, 0.1 is 10% slower. */
+    double delta_low;               /**< Lower end of the 95% confidence interval of the change. */
+    double delta_high;              /**< Upper end of the 95% confidence interval of the change. */
+    double p_value;                 /**< Two sided p-value of the Mann-Whitney U test. */
+} fossil_bench_compare_t;
+
+/**
+ * Complexity classes a range benchmark is fitted against.
+ */
+typedef enum {
+    FOSSIL_BENCH_O_1,
+    FOSSIL_BENCH_O_LOG_N,
+    FOSSIL_BENCH_O_N,
+    FOSSIL_BENCH_O_N_LOG_N,
+    FOSSIL_BENCH_O_N_SQUARED,
+    FOSSIL_BENCH_O_COUNT
+} fossil_bench_complexity_t;
+
+/**
+ * Structure holding the best least squares fit of time against input size.
+ */
+typedef struct {
+    bool valid;                           /**< At least two sizes were measured. */
+    fossil_bench_complexity_t complexity; /**< Class with the smallest error. */
+    double coefficient_ns;                /**< Nanoseconds per unit of the class, time = coefficient * f(n). */
+    double rms;                           /**< Root mean square error relative to the mean time. */
+} fossil_bench_fit_t;
+
+/**
+ * Structure holding the throughput of a benchmark that declared how much it
+ * processes per iteration. The rate is taken per sample, then summarised.
+ */
+typedef struct {
+    uint64_t per_iteration; /**< Bytes or items processed per iteration, 0 when not declared. */
+    double median;          /**< Median rate over the samples, per second. */
+    double mad;             /**< Median absolute deviation of the rate, per second. */
+    double min;             /**< Lowest rate kept after outlier rejection, per second. */
+} fossil_bench_rate_t;
+
+/**
+ * Structure representing a benchmark defined with FOSSIL_BENCH.
+ * The harness calibrates the number of iterations so one sample takes about
+ * FOSSIL_BENCH_SAMPLE_NS, warms up, then collects FOSSIL_BENCH_SAMPLES samples.
+ * Cold benchmarks then take as many samples again of one iteration each, with
+ * the caches evicted before every one.
+ */
+struct fossil_bench_t {
+    const char *name;                         /**< Name of the benchmark. */
+    fossil_bench_function_t function;         /**< Body of the benchmark. */
+    fossil_bench_function_t iteration_setup;  /**< Runs before every iteration with the timer paused, xnull for none. */
+    int64_t arg;                              /**< Input size of a range benchmark point, 0 otherwise. */
+    int32_t variant;                          /**< Implementation an A/B benchmark runs, 0 otherwise. */
+    const char *variant_name;                 /**< Name of that implementation, xnull outside A/B benchmarks. */
+    void *working_set;                        /**< Buffer of arg bytes in a working set benchmark, xnull otherwise. */
+    int32_t thread_index;                     /**< Index of the thread running this copy of the body. */
+    int32_t thread_count;                     /**< Threads running the body at once, 1 outside scaling runs. */
+    uint64_t iterations;                      /**< Iterations per sample, chosen by calibration. */
+    uint64_t remaining;                       /**< Iterations left in the running sample. */
+    fossil_bench_timer_t timer;               /**< Timer of the running sample. */
+    uint64_t elapsed_ns;                      /**< Duration of the last sample. */
+    bool running;                             /**< A sample is being timed by FOSSIL_BENCH_LOOP. */
+    bool looped;                              /**< The body drives its own loop. */
+    bool counting;                            /**< Perf counters are read around every sample. */
+    int32_t sample_count;                     /**< Number of samples collected. */
+    double samples[FOSSIL_BENCH_MAX_SAMPLES]; /**< Nanoseconds per iteration of every sample. */
+    fossil_bench_stats_t stats;               /**< Statistics over the collected samples. */
+    fossil_bench_counters_t counters;         /**< Perf counter totals over the collected samples. */
+    fossil_bench_counters_t counters_begin;   /**< Perf counter reading at the start of the running sample. */
+    uint64_t counted_iterations;              /**< Iterations covered by the counter totals. */
+    bool alloc_counting;                      /**< Heap allocations are counted around every sample. */
+    double alloc_limit;                       /**< Most allocations allowed per iteration, negative for no limit. */
+    fossil_test_allocs_t allocs;              /**< Allocation totals over the collected samples. */
+    fossil_test_allocs_t allocs_scope;        /**< Allocation scope of the running sample. */
+    uint64_t alloc_iterations;                /**< Iterations covered by the allocation totals. */
+    fossil_bench_compare_t compare;           /**< Comparison against the baseline, if any. */
+    fossil_bench_rate_t processed_bytes;      /**< Bytes per second, when the body declared its bytes. */
+    fossil_bench_rate_t processed_items;      /**< Items per second, when the body declared its items. */
+    bool latency_wanted;                      /**< The body records latencies, a histogram is set up after warmup. */
+    bool latency_laps;                        /**< Every FOSSIL_BENCH_LOOP iteration is recorded as one operation. */
+    uint64_t latency_last;                    /**< Tick at the end of the previous iteration. */
+    fossil_bench_histogram_t *latency;        /**< Latencies of the kept samples, xnull when none are recorded. */
+    bool cold_wanted;                         /**< Cold samples are taken as well, with the caches evicted before each. */
+    bool cold_branches;                       /**< The branch predictors are disturbed before every cold sample too. */
+    const void *cold_data;                    /**< Range flushed before a cold sample, xnull to evict the whole of the caches. */
+    size_t cold_size;                         /**< Bytes of that range. */
+    int32_t cold_count;                       /**< Number of cold samples collected. */
+    double cold_samples[FOSSIL_BENCH_MAX_SAMPLES]; /**< Nanoseconds of every cold sample, one iteration each. */
+    fossil_bench_stats_t cold_stats;          /**< Statistics over the cold samples. */
+    fossil_bench_t *next;                     /**< Next benchmark that ran, in run order. */
+};
+
+/**
+ * Structure representing a benchmark defined with FOSSIL_BENCH_RANGE. The body
+ * runs once per input size, from low to high in geometric steps, and every size
+ * is sampled as a benchmark of its own named "name/size".
+ */
+struct fossil_bench_range_t {
+    fossil_bench_t bench;                            /**< Name and body shared by every size. */
+    int64_t low;                                     /**< First input size. */
+    int64_t high;                                    /**< Last input size, inclusive. */
+    int64_t multiplier;                              /**< Factor between two sizes. */
+    int32_t point_count;                             /**< Number of sizes measured. */
+    fossil_bench_t *points[FOSSIL_BENCH_MAX_POINTS]; /**< Benchmark of every size. */
+    fossil_bench_fit_t fit;                          /**< Complexity fit over the medians. */
+    fossil_bench_range_t *next;                      /**< Next range benchmark that ran. */
+};
+
+/**
+ * Structure representing a benchmark defined with FOSSIL_BENCH_AB. The body
+ * runs every implementation on the same input, picking it from bench->variant,
+ * and every variant is sampled as a benchmark of its own named "name/variant".
+ * The samples are interleaved: every round takes one sample of each variant in
+ * a shuffled order, so drift of the clock speed or temperature over the run
+ * hits all of them alike.
+ */
+struct fossil_bench_ab_t {
+    fossil_bench_t bench;                                     /**< Name and body shared by every variant. */
+    const char *const *variants;                              /**< Name of every variant, the first is the reference. */
+    int32_t variant_count;                                    /**< Number of variants sampled. */
+    fossil_bench_t *points[FOSSIL_BENCH_AB_VARIANTS];         /**< Benchmark of every variant. */
+    fossil_bench_compare_t versus[FOSSIL_BENCH_AB_VARIANTS];  /**< Every variant against the first, delta and 95% ci. */
+    fossil_bench_ab_t *next;                                  /**< Next A/B benchmark that ran. */
+};
+
+/**
+ * Function to read the monotonic clock used for test and benchmark timings.
+ *
+ * @return The current monotonic time in nanoseconds.
+ */
+uint64_t fossil_test_clock_ns(void);
+
+/**
+ * Function to pick the benchmark clock, calibrate it against the monotonic
+ * clock and measure its overhead. The runner calls it before the first case,
+ * timers call it too in case they run first. The measurement happens once,
+ * threads that call it meanwhile wait until it is done.
+ */
+void fossil_bench_clock_calibrate(void);
+
+/**
+ * Function to read the benchmark clock at the start of a timed stretch. Earlier
+ * instructions complete before the counter is read.
+ *
+ * @return The current tick.
+ */
+static inline uint64_t fossil_bench_ticks_start(void) {
+#if defined(FOSSIL_BENCH_CYCLES_X86) && defined(_MSC_VER)
+    if (_BENCH_CLOCK.cycles) {
+        _mm_lfence();
+        return __rdtsc();
+    }
+#elif defined(FOSSIL_BENCH_CYCLES_X86)
+    if (_BENCH_CLOCK.cycles) {
+        uint32_t lo, hi;
+        __asm__ __volatile__("lfence\n\trdtsc" : "=a"(lo), "=d"(hi) : : "memory");
+        return ((uint64_t)hi << 32) | lo;
+    }
+#elif defined(FOSSIL_BENCH_CYCLES_ARM64)
+    if (_BENCH_CLOCK.cycles) {
+        uint64_t ticks;
+        __asm__ __volatile__("isb\n\tmrs %0, cntvct_el0" : "=r"(ticks) : : "memory");
+        return ticks;
+    }
+#endif
+    return fossil_test_clock_ns();
+}
+
+/**
+ * Function to read the benchmark clock at the end of a timed stretch. The
+ * counter is read after the timed instructions complete, and later
+ * instructions do not start before it.
+ *
+ * @return The current tick.
+ */
+static inline uint64_t fossil_bench_ticks_stop(void) {
+#if defined(FOSSIL_BENCH_CYCLES_X86) && defined(_MSC_VER)
+    if (_BENCH_CLOCK.rdtscp) {
+        unsigned int aux;
+        uint64_t ticks = __rdtscp(&aux);
+        _mm_lfence();
+        return ticks;
+    }
+#elif defined(FOSSIL_BENCH_CYCLES_X86)
+    if (_BENCH_CLOCK.rdtscp) {
+        uint32_t lo, hi, aux;
+        __asm__ __volatile__("rdtscp\n\tlfence" : "=a"(lo), "=d"(hi), "=c"(aux) : : "memory");
+        return ((uint64_t)hi << 32) | lo;
+    }
+#endif
+    return fossil_bench_ticks_start();
+}
+
+/**
+ * Function to convert ticks of the benchmark clock to nanoseconds.
+ *
+ * @param ticks The number of ticks.
+ * @return The same duration in nanoseconds.
+ */
+uint64_t fossil_bench_ticks_to_ns(uint64_t ticks);
+
+/**
+ * Function to start a timer from zero.
+ *
+ * @param timer The timer to start.
+ */
+void fossil_bench_timer_start(fossil_bench_timer_t *timer);
+
+/**
+ * Function to read the time a timer has been running, without stopping it.
+ *
+ * @param timer The timer to read.
+ * @return The elapsed time in nanoseconds, paused stretches excluded.
+ */
+uint64_t fossil_bench_timer_elapsed(const fossil_bench_timer_t *timer);
+
+/**
+ * Function to take a lap of a running timer.
+ *
+ * @param timer The timer to read.
+ * @return The elapsed time since the previous lap, or the start, in nanoseconds.
+ */
+uint64_t fossil_bench_timer_lap(fossil_bench_timer_t *timer);
+
+/**
+ * Function to pause a timer, time does not count until it is resumed.
+ *
+ * @param timer The timer to pause.
+ */
+void fossil_bench_timer_pause(fossil_bench_timer_t *timer);
+
+/**
+ * Function to resume a paused timer.
+ *
+ * @param timer The timer to resume.
+ */
+void fossil_bench_timer_resume(fossil_bench_timer_t *timer);
+
+/**
+ * Function to stop a timer.
+ *
+ * @param timer The timer to stop.
+ * @return The elapsed time in nanoseconds, paused stretches excluded.
+ */
+uint64_t fossil_bench_timer_stop(fossil_bench_timer_t *timer);
+
 /**
- * Function to test benchmark with specified duration type, expected value, and actual value.
+ * Function to report a benchmark that went over its time limit.
  * 
- * @param duration_type The duration type to test.
- * @param expected The expected value.
- * @param actual The actual value.
+ * @param duration_type The unit of the limit, such as "seconds".
+ * @param elapsed The elapsed time in nanoseconds.
+ * @param limit The time limit in the given unit.
  */
-void fossil_test_benchmark(char* duration_type, double expected, double actual);
+void fossil_test_benchmark(char* duration_type, double elapsed, double limit);
 
 /**
- * Function to start the benchmark.
+ * Function to start the benchmark timer of the calling thread.
  */
 void fossil_test_start_benchmark(void);
 
 /**
- * Function to stop the benchmark and return the elapsed time in nanoseconds.
+ * Function to read the benchmark timer of the calling thread without stopping it.
+ * 
+ * @return The elapsed time in nanoseconds.
+ */
+uint64_t fossil_test_elapsed_benchmark(void);
+
+/**
+ * Function to stop the benchmark timer of the calling thread.
  * 
  * @return The elapsed time in nanoseconds.
  */
 uint64_t fossil_test_stop_benchmark(void);
 
+/**
+ * Function to run a benchmark: calibrate, warm up, sample, then compute and
+ * report the statistics through the runner.
+ *
+ * @param bench The benchmark to run.
+ * @param name The name of the benchmark.
+ * @param function The body of the benchmark.
+ */
+void fossil_bench_run(fossil_bench_t *bench, const char *name, fossil_bench_function_t function);
+
+/**
+ * Function to sample a test case tagged "performance" in bench mode. Every
+ * call of the case is one sample of one iteration, one call that is not kept
+ * warms up first, and the statistics are reported like any benchmark.
+ *
+ * @param bench The benchmark that holds the samples of the case.
+ * @param name The name of the case.
+ * @param function The test function of the case.
+ */
+void fossil_bench_run_case(fossil_bench_t *bench, const char *name, void (*function)(void));
+
+/**
+ * Function to run one sample of a benchmark with its current iteration count.
+ *
+ * @param bench The benchmark, with its name, body and iterations set.
+ * @return The duration of the timed region in nanoseconds.
+ */
+uint64_t fossil_bench_sample(fossil_bench_t *bench);
+
+/**
+ * Function to grow the iteration count of a benchmark until one sample takes
+ * about the target time.
+ *
+ * @param bench The benchmark, with its name and body set.
+ * @param target_ns The duration one sample should take.
+ */
+void fossil_bench_calibrate(fossil_bench_t *bench, uint64_t target_ns);
+
+/**
+ * Function to run a benchmark over a range of input sizes, then fit the medians
+ * to the complexity classes and report the best fit.
+ *
+ * @param range The range benchmark to run.
+ * @param name The name of the benchmark.
+ * @param function The body of the benchmark, it reads the size from bench->arg.
+ * @param low The first input size.
+ * @param high The last input size, inclusive.
+ * @param multiplier The factor between two sizes, at least 2.
+ */
+void fossil_bench_run_range(fossil_bench_range_t *range, const char *name, fossil_bench_function_t function,
+    int64_t low, int64_t high, int64_t multiplier);
+
+/**
+ * Function to run two or more implementations with interleaved samples and
+ * report the speedup of every one over the first with its confidence interval.
+ *
+ * @param ab The A/B benchmark to run.
+ * @param name The name of the benchmark.
+ * @param function The body of the benchmark, it picks the implementation from bench->variant.
+ * @param variants The name of every implementation, the first is the reference.
+ * @param count The number of implementations, at most FOSSIL_BENCH_AB_VARIANTS.
+ */
+void fossil_bench_run_ab(fossil_bench_ab_t *ab, const char *name, fossil_bench_function_t function,
+    const char *const *variants, int32_t count);
+
+/**
+ * Function to fit times against input sizes to O(1), O(log n), O(n),
+ * O(n log n) and O(n^2), keeping the class with the smallest error.
+ *
+ * @param sizes Input sizes.
+ * @param times Nanoseconds per iteration at every size.
+ * @param count The number of sizes.
+ * @param fit The fit to fill in, invalid with less than two sizes.
+ */
+void fossil_bench_fit(const double *sizes, const double *times, int32_t count, fossil_bench_fit_t *fit);
+
+/**
+ * Function to name a complexity class, such as "O(n log n)".
+ *
+ * @param complexity The class.
+ * @return The name.
+ */
+const char *fossil_bench_complexity_name(fossil_bench_complexity_t complexity);
+
+/**
+ * Function to compute the statistics of a set of samples.
+ *
+ * @param samples Nanoseconds per iteration of every sample.
+ * @param count The number of samples.
+ * @param stats The statistics to fill in.
+ */
+void fossil_bench_stats(const double *samples, int32_t count, fossil_bench_stats_t *stats);
+
+/**
+ * Function to set up the latency histogram of a benchmark once it is warm,
+ * when the body records latencies.
+ *
+ * @param bench The benchmark.
+ * @return The empty histogram, xnull when the body records nothing.
+ */
+fossil_bench_histogram_t *fossil_bench_latency_create(const fossil_bench_t *bench);
+
+/**
+ * Function to write the latency histogram of every benchmark that recorded
+ * latencies to one file, see fossil_bench_histogram_export.
+ *
+ * @param path The file to write.
+ * @param benches The benchmarks that ran, in run order.
+ * @param scalings The scaling benchmarks that ran, in run order.
+ * @return True when the file was written.
+ */
+bool fossil_bench_latency_save(const char *path, const fossil_bench_t *benches, const fossil_bench_scaling_t *scalings);
+
+/**
+ * Function called at the start and the end of every sample timed by
+ * FOSSIL_BENCH_LOOP.
+ *
+ * @param bench The running benchmark.
+ * @return True when the sample starts, false when it is over.
+ */
+bool fossil_bench_sample_edge(fossil_bench_t *bench);
+
+/**
+ * Function to stop counting time inside an iteration, for work that must not
+ * be measured such as restoring the input the iteration mutates.
+ *
+ * @param bench The running benchmark.
+ */
+void fossil_bench_pause(fossil_bench_t *bench);
+
+/**
+ * Function to count time again after fossil_bench_pause. Every timed stretch
+ * has the overhead of one clock start and stop subtracted, and the paused
+ * time is left out of the latency of the iteration as well.
+ *
+ * @param bench The running benchmark.
+ */
+void fossil_bench_resume(fossil_bench_t *bench);
+
+/**
+ * Function to run the iteration setup of a benchmark with the timer paused.
+ *
+ * @param bench The running benchmark.
+ */
+void fossil_bench_iteration_setup(fossil_bench_t *bench);
+
+/**
+ * Function the optimization barriers fall back to on compilers without GNU
+ * inline assembly. It is defined in another translation unit, so the compiler
+ * has to assume the pointed memory is read and written by it.
+ *
+ * @param ptr The memory to keep.
+ */
+void fossil_bench_use_pointer(const volatile void *ptr);
+
+/**
+ * Function to keep the memory behind a pointer alive: the compiler has to
+ * produce its value before this point and cannot drop the work behind it.
+ *
+ * @param ptr The memory to keep.
+ */
+static inline void fossil_bench_do_not_optimize(const void *ptr) {
+#if defined(__GNUC__) || defined(__clang__)
+    __asm__ __volatile__("" : : "r"(ptr) : "memory");
+#else
+    fossil_bench_use_pointer(ptr);
+#endif
+}
+
+/**
+ * Function to make the compiler treat all memory as read and written here, so
+ * stores before it are not dropped and loads after it are not hoisted.
+ */
+static inline void fossil_bench_clobber_memory(void) {
+#if defined(__GNUC__) || defined(__clang__)
+    __asm__ __volatile__("" : : : "memory");
+#elif defined(_MSC_VER)
+    _ReadWriteBarrier();
+#else
+    fossil_bench_use_pointer(xnull);
+#endif
+}
+
+/**
+ * Function to record the latency of one operation of a benchmark. Nothing is
+ * kept during calibration and warmup. Every thread of a scaling benchmark
+ * records into a histogram of its own.
+ *
+ * @param bench The running benchmark.
+ * @param ns The latency in nanoseconds.
+ */
+static inline void fossil_bench_record_latency(fossil_bench_t *bench, uint64_t ns) {
+    bench->latency_wanted = true;
+    if (bench->latency != xnull) {
+        fossil_bench_histogram_record(bench->latency, ns);
+    }
+}
+
+/**
+ * Function to record the iteration that just ended, from the clock reading at
+ * the end of the previous one, less the overhead of the clock.
+ *
+ * @param bench The running benchmark.
+ */
+static inline void fossil_bench_latency_lap(fossil_bench_t *bench) {
+    uint64_t now = fossil_bench_ticks_stop();
+    if (bench->running) {
+        uint64_t ticks = now - bench->latency_last;
+        ticks = ticks > _BENCH_CLOCK.overhead_ticks ? ticks - _BENCH_CLOCK.overhead_ticks : 0;
+        fossil_bench_histogram_record(bench->latency, (uint64_t)((double)ticks * _BENCH_CLOCK.ns_per_tick));
+    }
+    bench->latency_last = now;
+}
+
+/**
+ * Function to step the loop of a benchmark body. Only a counter is touched
+ * between two iterations, the clock is read once per sample unless the body
+ * asked for the latency of every iteration. Memory is clobbered between
+ * iterations so stores of one iteration are not merged into the next or
+ * dropped.
+ *
+ * @param bench The running benchmark.
+ * @return True while there are iterations left in the sample.
+ */
+static inline bool fossil_bench_keep_running(fossil_bench_t *bench) {
+    fossil_bench_clobber_memory();
+    if (bench->latency_laps && bench->latency != xnull) {
+        fossil_bench_latency_lap(bench);
+    }
+    if (bench->remaining > 0) {
+        bench->remaining--;
+        if (bench->iteration_setup != xnull) {
+            fossil_bench_iteration_setup(bench);
+        }
+        return true;
+    }
+    return fossil_bench_sample_edge(bench);
+}
+
+/**
+ * @brief Macro to define a benchmark.
+ *
+ * Defines the benchmark, its body taking `fossil_bench_t *bench`, and a test
+ * case with the "performance" tag that runs it, so it is added with ADD_TEST.
+ *
+ * @param name The name of the benchmark.
+ */
+#define _FOSSIL_BENCH(name)                                                    \
+    void name##_fossil_bench(fossil_bench_t *bench);                          \
+    fossil_bench_t name##_xbench;                                             \
+    void name##_fossil_test(void) {                                           \
+        fossil_bench_run(&name##_xbench, #name, name##_fossil_bench);         \
+    }                                                                         \
+    fossil_test_t name = {                                                    \
+        (char*)#name,                                                         \
+        xnull,                                                                \
+        xnull,                                                                \
+        name##_fossil_test,                                                   \
+        (char*)"performance",                                                 \
+        (char*)"fossil",                                                      \
+        {0, 0, 0, {0, 0, 0, 0, 0}},                                           \
+        {xnull, xnull},                                                       \
+        0,                                                                    \
+        &name##_xbench,                                                       \
+        xnull,                                                                \
+        xnull                                                                 \
+    };                                                                        \
+    void name##_fossil_bench(fossil_bench_t *bench)
+
+/**
+ * @brief Macro to define a benchmark over a range of input sizes.
+ *
+ * @param name The name of the benchmark.
+ * @param first The first input size.
+ * @param last The last input size.
+ * @param factor The factor between two sizes.
+ */
+#define _FOSSIL_BENCH_RANGE(name, first, last, factor)                        \
+    void name##_fossil_bench(fossil_bench_t *bench);                          \
+    fossil_bench_range_t name##_xrange;                                       \
+    void name##_fossil_test(void) {                                           \
+        fossil_bench_run_range(&name##_xrange, #name, name##_fossil_bench,    \
+            (first), (last), (factor));                                       \
+    }                                                                         \
+    fossil_test_t name = {                                                    \
+        (char*)#name,                                                         \
+        xnull,                                                                \
+        xnull,                                                                \
+        name##_fossil_test,                                                   \
+        (char*)"performance",                                                 \
+        (char*)"fossil",                                                      \
+        {0, 0, 0, {0, 0, 0, 0, 0}},                                           \
+        {xnull, xnull},                                                       \
+        0,                                                                    \
+        &name##_xrange.bench,                                                 \
+        xnull,                                                                \
+        xnull                                                                 \
+    };                                                                        \
+    void name##_fossil_bench(fossil_bench_t *bench)
+
+/**
+ * @brief Macro to define a benchmark that interleaves implementations.
+ *
+ * @param name The name of the benchmark.
+ * @param variants A static array with the name of every implementation.
+ */
+#define _FOSSIL_BENCH_AB(name, variants)                                      \
+    void name##_fossil_bench(fossil_bench_t *bench);                          \
+    fossil_bench_ab_t name##_xab;                                             \
+    void name##_fossil_test(void) {                                           \
+        fossil_bench_run_ab(&name##_xab, #name, name##_fossil_bench,          \
+            (variants), (int32_t)(sizeof(variants) / sizeof((variants)[0]))); \
+    }                                                                         \
+    fossil_test_t name = {                                                    \
+        (char*)#name,                                                         \
+        xnull,                                                                \
+        xnull,                                                                \
+        name##_fossil_test,                                                   \
+        (char*)"performance",                                                 \
+        (char*)"fossil",                                                      \
+        {0, 0, 0, {0, 0, 0, 0, 0}},                                           \
+        {xnull, xnull},                                                       \
+        0,                                                                    \
+        &name##_xab.bench,                                                    \
+        xnull,                                                                \
+        xnull                                                                 \
+    };                                                                        \
+    void name##_fossil_bench(fossil_bench_t *bench)
+
+#define _FOSSIL_BENCH_PAUSE(bench) fossil_bench_pause(bench)
+
+#define _FOSSIL_BENCH_RESUME(bench) fossil_bench_resume(bench)
+
+#define _FOSSIL_BENCH_SETUP_ITERATION(bench, function) ((bench)->iteration_setup = (function))
+
+#define _FOSSIL_BENCH_COLD(bench) ((bench)->cold_wanted = true)
+
+#define _FOSSIL_BENCH_COLD_RANGE(bench, data, size) \
+    ((bench)->cold_wanted = true, (bench)->cold_data = (const void*)(data), (bench)->cold_size = (size_t)(size))
+
+#define _FOSSIL_BENCH_COLD_BRANCHES(bench) ((bench)->cold_wanted = true, (bench)->cold_branches = true)
+
+#define _FOSSIL_BENCH_EXPECT_ALLOCS(bench, limit) ((bench)->alloc_limit = (double)(limit))
+
+#define _FOSSIL_BENCH_SET_BYTES(bench, count) ((bench)->processed_bytes.per_iteration = (uint64_t)(count))
+
+#define _FOSSIL_BENCH_SET_ITEMS(bench, count) ((bench)->processed_items.per_iteration = (uint64_t)(count))
+
+#define _FOSSIL_BENCH_RECORD_LATENCY(bench) ((bench)->latency_wanted = true, (bench)->latency_laps = true)
+
+#define _FOSSIL_BENCH_RECORD(bench, ns) fossil_bench_record_latency((bench), (uint64_t)(ns))
+
+#define _FOSSIL_BENCH_DO_NOT_OPTIMIZE(value) fossil_bench_do_not_optimize((const void*)&(value))
+
+#define _FOSSIL_BENCH_CLOBBER_MEMORY() fossil_bench_clobber_memory()
+
+#define _FOSSIL_BENCH_LOOP(bench) while (fossil_bench_keep_running(bench))
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,72 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FOSSIL_TEST_COLD_H
+#define FOSSIL_TEST_COLD_H
+
+#include "fossil/_common/common.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Cold starts for benchmarks. Code that only ever runs once, such as the first
+ * request after a deploy, finds its data in memory rather than in the caches
+ * and its branches unknown to the predictors. These functions put the machine
+ * back into roughly that state between two samples.
+ */
+
+/**
+ * Function to evict the data caches by reading through a buffer larger than
+ * all cache levels of the host together. The buffer is allocated and touched
+ * on first use and kept until fossil_bench_evict_release. When the cache
+ * sizes are unknown a buffer of 64 MiB is used.
+ */
+void fossil_bench_evict_caches(void);
+
+/**
+ * Function to flush a range of memory out of every cache level. Uses CLFLUSH
+ * on x86-64 and DC CIVAC on AArch64, elsewhere it falls back to evicting the
+ * whole of the caches.
+ *
+ * @param data The start of the range.
+ * @param size The size of the range in bytes.
+ */
+void fossil_bench_flush_range(const void *data, size_t size);
+
+/**
+ * Function to disturb the branch predictors by running a stretch of
+ * conditional branches, jumps and indirect calls on random data. This is a
+ * best effort: it overwrites the history the predictors keep, it cannot
+ * clear it.
+ */
+void fossil_bench_disturb_branches(void);
+
+/**
+ * Function to free the buffer fossil_bench_evict_caches reads through.
+ */
+void fossil_bench_evict_release(void);
+
+/**
+ * Function to get the size of the buffer fossil_bench_evict_caches reads through.
+ *
+ * @return The size in bytes, from the cache sizes of the host.
+ */
+size_t fossil_bench_evict_bytes(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -32,6 +32,7 @@ typedef struct {
     bool reverse;
     bool repeat_enabled;
     int repeat_count;
+    bool bench_mode;       // runs only benchmarks and performance cases, every repeat is one sample
     bool shuffle_enabled;
     bool verbose_enabled;
     int verbose_level; // 0 for cutback, 1 for normal, 2 for verbose
@@ -39,6 +40,26 @@ typedef struct {
     bool summary_enabled;
     bool color_enabled;
     bool sanity_enabled;
+    bool progress_enabled; // live progress display in cutback mode when stdout is a TTY
+    bool slowest_enabled;  // timing section with the slowest cases in the summary
+    int slowest_count;
+    bool capture_enabled;  // buffer stdout/stderr of each case, shown only on failure
+    bool counters_enabled; // perf event counters around benchmark samples and test cases
+    bool allocs_enabled;   // heap allocation counts around test cases, benchmarks always count
+    char bench_save_file[256];      // benchmark samples are written here after the run
+    char bench_compare_file[256];   // benchmark samples are compared against this baseline
+    char bench_histogram_file[256]; // latency histograms are written here after the run
+    double bench_threshold;         // slowdown in percent that fails a benchmark when significant
+    int bench_threads;              // most threads of a scaling benchmark, 0 for the number of CPUs
+    int bench_cpu;                  // CPU the runner is pinned to before benchmarks, -1 to leave it
+    bool bench_priority;            // raise the scheduling priority before benchmarks
+    bool bench_cold;                // every benchmark is also sampled with the caches evicted
+    bool bench_cold_branches;       // the branch predictors are disturbed before cold samples too
+    bool compare_enabled;           // the compare command was given, its files may still be missing
+    char compare_old_file[256];     // saved benchmark results compared by the compare command
+    char compare_new_file[256];
+    bool compare_json;              // print the comparison as JSON instead of a table
+    char trace_file[256];           // spans of cases, steps and benchmark samples are written here after the run
 } fossil_options_t;
 
 extern fossil_options_t _CLI;
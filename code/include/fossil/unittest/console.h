@@ -15,6 +15,9 @@ Description:
 
 #include "fossil/_common/common.h"
 #include "internal.h"
+#include "counters.h"
+#include "allocs.h"
+#include "baseline.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -30,6 +33,15 @@ extern "C"
  */
 void fossil_test_cout(const char* color_name, const char* format, ...);
 
+/**
+ * Function to point framework output at another stream, so what the console
+ * renders can be read back. Hand the returned stream back to undo it.
+ *
+ * @param stream The stream to write to, xnull for stdout.
+ * @return The stream that was written to before, xnull for stdout.
+ */
+FILE *fossil_test_io_console(FILE *stream);
+
 void fossil_test_io_information(void);
 void fossil_test_io_sanity_load(fossil_test_t *test);
 void fossil_test_io_unittest_given(char *description);
@@ -43,6 +55,109 @@ void fossil_test_io_asserted(xassert_info *assume);
 void fossil_test_io_summary_start(void);
 void fossil_test_io_summary_ended(void);
 
+/**
+ * Function to report the slowest cases, the p50/p90/p99/max case durations and
+ * the time per tag and per group in the summary. Sorts the timings slowest first.
+ *
+ * @param timings The wall time of every case that ran.
+ * @param count The number of timings.
+ */
+void fossil_test_io_timings(fossil_test_timing_t *timings, int32_t count);
+
+/**
+ * Function to report the statistics of a benchmark once it has been sampled.
+ *
+ * @param bench The benchmark that just ran.
+ */
+void fossil_test_io_bench_result(const fossil_bench_t *bench);
+
+/**
+ * Function to report the complexity fit of a range benchmark once every size ran.
+ *
+ * @param range The range benchmark that just ran.
+ */
+void fossil_test_io_bench_fit(const fossil_bench_range_t *range);
+
+/**
+ * Function to report perf counters next to the timing of a case or benchmark.
+ *
+ * @param counters Counter totals, events that were not counted are skipped.
+ * @param operations Number of operations the totals cover, 1 for a test case.
+ */
+void fossil_test_io_counters(const fossil_bench_counters_t *counters, uint64_t operations);
+
+/**
+ * Function to report the speedup of every variant of an A/B benchmark.
+ *
+ * @param ab The A/B benchmark that just ran.
+ */
+void fossil_test_io_bench_ab(const fossil_bench_ab_t *ab);
+
+/**
+ * Function to report the scaling table of a thread scaling benchmark.
+ *
+ * @param scaling The scaling benchmark that just ran.
+ */
+void fossil_test_io_bench_scaling(const fossil_bench_scaling_t *scaling);
+
+/**
+ * Function to report the slowdown at every cache level of a working set benchmark.
+ *
+ * @param working_set The working set benchmark that just ran.
+ */
+void fossil_test_io_bench_working_set(const fossil_bench_working_set_t *working_set);
+
+/**
+ * Function to report heap allocations next to the timing of a case or benchmark.
+ *
+ * @param allocs Allocation totals, nothing is printed when they were not counted.
+ * @param operations Number of operations the totals cover, 1 for a test case.
+ */
+void fossil_test_io_allocs(const fossil_test_allocs_t *allocs, uint64_t operations);
+
+/**
+ * Function to print the comparison of two baseline files.
+ *
+ * @param old_path The baseline of the old run.
+ * @param old_host The host line of the old run, empty when it has none.
+ * @param new_path The baseline of the new run.
+ * @param new_host The host line of the new run, empty when it has none.
+ * @param rows The compared benchmarks, sorted by impact.
+ * @param count The number of rows.
+ * @param json Print JSON instead of a table.
+ */
+void fossil_test_io_bench_report(const char *old_path, const char *old_host, const char *new_path, const char *new_host,
+    const fossil_bench_report_row_t *rows, int32_t count, bool json);
+
+/**
+ * Live progress display for cutback mode on a TTY. When stdout is not a
+ * terminal, or progress is disabled, these fall back to the plain markers.
+ * The ETA starts from the durations benchmarks had in an earlier run.
+ *
+ * @param queue The test cases that are about to run.
+ * @param total The number of test cases that are about to run.
+ */
+void fossil_test_io_progress_start(const fossil_test_queue_t *queue, int32_t total);
+bool fossil_test_io_progress_active(void);
+void fossil_test_io_progress_update(fossil_test_t *test);
+void fossil_test_io_progress_ended(void);
+
+/**
+ * Per case output capture. While a case runs its stdout and stderr are
+ * redirected into reusable in-memory buffers, the framework keeps writing to
+ * the real terminal. The captured text is printed only when the case failed
+ * or the runner is verbose. Capture is a no-op on Windows, and the run goes
+ * on without it when the buffers cannot be opened; active tells whether the
+ * output of the running case is being captured.
+ *
+ * @param failed Whether the case that just ran failed.
+ */
+bool fossil_test_io_capture_active(void);
+void fossil_test_io_capture_start(void);
+void fossil_test_io_capture_begin(void);
+void fossil_test_io_capture_ended(bool failed);
+void fossil_test_io_capture_stop(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,90 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FOSSIL_TEST_COUNTERS_H
+#define FOSSIL_TEST_COUNTERS_H
+
+#include "fossil/_common/common.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Hardware and software events counted around benchmark samples, and around
+ * whole test cases when the `counters` option is enabled. Counting relies on
+ * Linux perf_event_open; elsewhere, or when the kernel refuses (for example in
+ * a container with a strict perf_event_paranoid), only wall time is reported.
+ */
+typedef enum {
+    FOSSIL_BENCH_COUNTER_CYCLES,
+    FOSSIL_BENCH_COUNTER_INSTRUCTIONS,
+    FOSSIL_BENCH_COUNTER_L1D_MISSES,
+    FOSSIL_BENCH_COUNTER_LLC_MISSES,
+    FOSSIL_BENCH_COUNTER_BRANCH_MISSES,
+    FOSSIL_BENCH_COUNTER_CONTEXT_SWITCHES,
+    FOSSIL_BENCH_COUNTER_COUNT
+} fossil_bench_counter_t;
+
+/**
+ * Structure holding one reading, or the sum of several deltas, of every event.
+ */
+typedef struct {
+    bool valid[FOSSIL_BENCH_COUNTER_COUNT];      /**< The event could be opened and read. */
+    uint64_t value[FOSSIL_BENCH_COUNTER_COUNT];  /**< Event count, scaled when the kernel multiplexed it. */
+} fossil_bench_counters_t;
+
+/**
+ * Function to open the counter group of the calling thread. The group is
+ * opened once per thread and stays open until closed; later calls only report
+ * whether it is available.
+ *
+ * @return True when at least one event is being counted.
+ */
+bool fossil_bench_counters_open(void);
+
+/**
+ * Function to close the counter group of the calling thread.
+ */
+void fossil_bench_counters_close(void);
+
+/**
+ * Function to read every event of the calling thread's group at once.
+ *
+ * @param reading The reading to fill in.
+ * @return True when the group was read.
+ */
+bool fossil_bench_counters_read(fossil_bench_counters_t *reading);
+
+/**
+ * Function to add the difference between two readings to a running total.
+ *
+ * @param total The total to add to.
+ * @param begin The reading taken first.
+ * @param end The reading taken last.
+ */
+void fossil_bench_counters_accumulate(fossil_bench_counters_t *total, const fossil_bench_counters_t *begin, const fossil_bench_counters_t *end);
+
+/**
+ * Function to get the short name of an event, as printed in reports.
+ *
+ * @param counter The event.
+ * @return The name of the event.
+ */
+const char *fossil_bench_counters_name(fossil_bench_counter_t counter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
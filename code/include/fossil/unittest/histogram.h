@@ -0,0 +1,129 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FOSSIL_TEST_HISTOGRAM_H
+#define FOSSIL_TEST_HISTOGRAM_H
+
+#include "fossil/_common/common.h"
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Layout of the latency histogram
+enum {
+    FOSSIL_BENCH_HISTOGRAM_SUB_BITS = 8,  // values below 2^8 are exact, above that 128 steps per power of two
+    FOSSIL_BENCH_HISTOGRAM_MAX_BITS = 36, // larger values are clamped to 2^36 - 1 ns, about 68 seconds
+    FOSSIL_BENCH_HISTOGRAM_COUNTS = (FOSSIL_BENCH_HISTOGRAM_MAX_BITS - FOSSIL_BENCH_HISTOGRAM_SUB_BITS + 2) << (FOSSIL_BENCH_HISTOGRAM_SUB_BITS - 1)
+};
+
+/**
+ * Structure representing a high dynamic range histogram of latencies in
+ * nanoseconds. Buckets are linear up to 256 ns, then every power of two is
+ * split into 128 equal steps, so a value read back from a bucket is within
+ * 1/128 (0.8%) of any value recorded into it, from 1 ns up to about a minute.
+ *
+ * Recording touches only the histogram itself and takes no lock. Every thread
+ * records into a histogram of its own, and they are merged once it is done.
+ */
+typedef struct {
+    uint64_t count;                                 /**< Number of values recorded. */
+    uint64_t min;                                   /**< Smallest value recorded, exact. */
+    uint64_t max;                                   /**< Largest value recorded, exact. */
+    double sum;                                     /**< Sum of the values, for the mean. */
+    uint64_t counts[FOSSIL_BENCH_HISTOGRAM_COUNTS]; /**< Number of values in every bucket. */
+} fossil_bench_histogram_t;
+
+/**
+ * Function to find the bucket of a value.
+ *
+ * @param value The value in nanoseconds.
+ * @return The index into counts.
+ */
+static inline int32_t fossil_bench_histogram_index(uint64_t value) {
+    const uint64_t limit = ((uint64_t)1 << FOSSIL_BENCH_HISTOGRAM_MAX_BITS) - 1;
+    if (value > limit) {
+        value = limit;
+    }
+    if (value < ((uint64_t)1 << FOSSIL_BENCH_HISTOGRAM_SUB_BITS)) {
+        return (int32_t)value;
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    int32_t magnitude = 63 - __builtin_clzll(value);
+#else
+    int32_t magnitude = 0;
+    for (uint64_t rest = value >> 1; rest != 0; rest >>= 1) {
+        magnitude++;
+    }
+#endif
+    int32_t shift = magnitude - (FOSSIL_BENCH_HISTOGRAM_SUB_BITS - 1);
+    return (shift << (FOSSIL_BENCH_HISTOGRAM_SUB_BITS - 1)) + (int32_t)(value >> shift);
+}
+
+/**
+ * Function to record one value.
+ *
+ * @param histogram The histogram of the calling thread.
+ * @param value The value in nanoseconds.
+ */
+static inline void fossil_bench_histogram_record(fossil_bench_histogram_t *histogram, uint64_t value) {
+    histogram->counts[fossil_bench_histogram_index(value)]++;
+    histogram->min = histogram->count == 0 || value < histogram->min ? value : histogram->min;
+    histogram->max = value > histogram->max ? value : histogram->max;
+    histogram->sum += (double)value;
+    histogram->count++;
+}
+
+/**
+ * Function to empty a histogram.
+ *
+ * @param histogram The histogram to empty.
+ */
+void fossil_bench_histogram_reset(fossil_bench_histogram_t *histogram);
+
+/**
+ * Function to add every value of one histogram to another.
+ *
+ * @param into The histogram that receives the values.
+ * @param from The histogram to add, left unchanged.
+ */
+void fossil_bench_histogram_merge(fossil_bench_histogram_t *into, const fossil_bench_histogram_t *from);
+
+/**
+ * Function to read a percentile. The value returned is the highest one that
+ * falls into the same bucket as the percentile, but never above the largest
+ * value recorded.
+ *
+ * @param histogram The histogram to read.
+ * @param percentile The percentile, from 0 to 100, such as 99.999.
+ * @return The value in nanoseconds, 0 when the histogram is empty.
+ */
+uint64_t fossil_bench_histogram_percentile(const fossil_bench_histogram_t *histogram, double percentile);
+
+/**
+ * Function to write a histogram as a percentile distribution in the text
+ * format of HdrHistogram ("Value Percentile TotalCount 1/(1-Percentile)"),
+ * one line per bucket that holds values, so the tail can be plotted.
+ *
+ * @param histogram The histogram to write.
+ * @param name The name written in the header line.
+ * @param file The file to write to.
+ */
+void fossil_bench_histogram_export(const fossil_bench_histogram_t *histogram, const char *name, FILE *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
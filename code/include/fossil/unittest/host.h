@@ -0,0 +1,56 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FOSSIL_TEST_HOST_H
+#define FOSSIL_TEST_HOST_H
+
+#include "fossil/_common/common.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Noise control for benchmark runs. Before the first benchmark the runner can
+ * pin itself to one CPU (`bench-cpu`) and raise its scheduling priority
+ * (`bench-priority`), and it warns about settings that make timings drift:
+ * a cpufreq governor other than "performance", turbo boost and SMT siblings
+ * sharing the core. Pinning and priority are supported on Linux and Windows.
+ */
+
+/**
+ * Function to apply the noise controls and print the warnings, once per run.
+ */
+void fossil_bench_host_prepare(void);
+
+/**
+ * Function to let a thread started by a benchmark run on every CPU the process
+ * could use before pinning, so scaling benchmarks are not squeezed onto the
+ * pinned CPU.
+ */
+void fossil_bench_host_release(void);
+
+/**
+ * Function to describe the host as "key value" pairs, with spaces inside values
+ * replaced by underscores, for the records saved with benchmark results.
+ *
+ * @param out The buffer to write.
+ * @param size The size of the buffer.
+ */
+void fossil_bench_host_describe(char *out, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
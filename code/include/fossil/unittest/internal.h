@@ -174,19 +174,48 @@ typedef struct {
  * This structure contains all the necessary information for a test case, including its name,
  * the function implementing the test, priority, tags, and links to setup and teardown functions.
  */
+typedef struct fossil_bench_t fossil_bench_t;
+typedef struct fossil_bench_range_t fossil_bench_range_t;
+typedef struct fossil_bench_ab_t fossil_bench_ab_t;
+typedef struct fossil_bench_scaling_t fossil_bench_scaling_t;
+typedef struct fossil_bench_working_set_t fossil_bench_working_set_t;
 typedef struct fossil_test_t fossil_test_t;
 typedef struct fossil_test_t {
     const char* name;            /**< Name of the test case. */
+    const char* display_name;    /**< Human readable name, computed once when the test is added. */
+    const char* group;           /**< Name of the test group that registered the test case. */
     void (*test_function)(void); /**< Function pointer to the test case's implementation. */
     char* tags;                  /**< Array of tags associated with the test case. */
     char* marks;                 /**< Array of marks associated with the test case. */
     fossil_test_timer_t timer;   /**< Timer for tracking the duration of the test case. */
     fossil_fixture_t fixture;    /**< The fixture settings for setup and teardown functions. */
     int32_t priority;            /**< Priority of the test case (higher value indicates higher priority). */
+    fossil_bench_t *bench;       /**< Benchmark driven by this case, xnull for plain test cases. */
     struct fossil_test_t *prev;  /**< Pointer to the previous fossil_test_t node in a linked list. */
     struct fossil_test_t *next;  /**< Pointer to the next fossil_test_t node in a linked list. */
 } fossil_test_t;
 
+/**
+ * Structure representing a bump arena for per-run bookkeeping.
+ * Strings derived from a test case (such as its display name) are copied into the
+ * arena once when the test is registered, so the reporting path never has to touch
+ * the heap while tests are running. Everything is released at once on exit.
+ */
+typedef struct fossil_test_arena_block_t fossil_test_arena_block_t;
+typedef struct {
+    fossil_test_arena_block_t *head; /**< Most recently allocated block, new data is carved from here. */
+} fossil_test_arena_t;
+
+/**
+ * Structure representing the wall time spent on one test case.
+ * The environment keeps one compact array of these per run, which feeds the
+ * slowest tests and latency distribution section of the summary.
+ */
+typedef struct {
+    uint64_t elapsed_ns;  /**< Wall time from setup to teardown in nanoseconds. */
+    fossil_test_t *test;  /**< The test case that was timed. */
+} fossil_test_timing_t;
+
 /**
  * Structure representing a deque (double-ended queue) for managing test cases.
  * This structure allows for the addition and removal of test cases from both ends of the queue.
@@ -214,6 +243,31 @@ typedef struct {
                                            from an assert. */
 } fossil_test_score_t;
 
+/**
+ * @brief Enumeration representing the kind of operands attached to an assertion.
+ *
+ * Comparisons on strings and buffers attach their operands so a failure can be
+ * rendered as a side-by-side text diff or hexdump instead of just a message.
+ */
+typedef enum {
+    TEST_OPERAND_AS_NONE,  /**< No operands, only the message is reported. */
+    TEST_OPERAND_AS_TEXT,  /**< NUL terminated strings, rendered as a line diff. */
+    TEST_OPERAND_AS_BYTES  /**< Raw buffers or structs, rendered as a hexdump. */
+} xassert_operand_t;
+
+/**
+ * Structure representing the operands of a failed comparison.
+ * Only pointers are captured when the comparison runs; sizes of text operands and
+ * the diff itself are worked out lazily when the failure is rendered.
+ */
+typedef struct {
+    xassert_operand_t kind;  /**< Kind of payload held by the operands. */
+    const void *actual;      /**< Pointer to the actual value. */
+    const void *expected;    /**< Pointer to the expected value. */
+    size_t actual_size;      /**< Size of the actual value in bytes, unused for text. */
+    size_t expected_size;    /**< Size of the expected value in bytes, unused for text. */
+} xassert_operands_t;
+
 /**
  * Structure representing information about an assertion.
  * This structure contains detailed information about an assertion, including the name of the test case,
@@ -230,6 +284,7 @@ typedef struct {
     char *func;            /**< Function name where the assertion occurred. */
     char *file;            /**< File name where the assertion occurred. */
     char *message;         /**< Message associated with the assertion. */
+    xassert_operands_t operands; /**< Operands of the comparison that is being asserted, if any. */
 } xassert_info;
 
 /**
@@ -242,6 +297,16 @@ typedef struct {
     fossil_test_timer_t timer;                  /**< Timer for tracking the time taken to run the tests. */
     fossil_test_queue_t* queue;                /**< Queue to hold the test cases, allowing them to be managed and executed in order. */
     fossil_test_rule_t rule;                   /**< Rule for the test case, including whether it should pass, fail, or be skipped. */
+    fossil_test_arena_t arena;                 /**< Arena holding per-test strings computed at registration time. */
+    const char *current_group;                 /**< Name of the test group currently being imported. */
+    fossil_test_timing_t *timings;             /**< Per-test wall times for this run, one entry per executed case. */
+    int32_t timing_count;                      /**< Number of entries used in the timings array. */
+    int32_t timing_capacity;                   /**< Number of entries available in the timings array. */
+    fossil_bench_t *benches;                   /**< Benchmarks that ran, in run order, for the summary. */
+    fossil_bench_range_t *ranges;              /**< Range benchmarks that ran, with their complexity fit. */
+    fossil_bench_scaling_t *scalings;          /**< Thread scaling benchmarks that ran, with their tables. */
+    fossil_bench_working_set_t *working_sets;  /**< Working set benchmarks that ran, around every cache level. */
+    fossil_bench_ab_t *ab_benches;             /**< A/B benchmarks that ran, with the speedup of every variant. */
     uint8_t current_except_count; /**< Counter for the number of exceptions that occurred during testing. */
     uint8_t current_assume_count; /**< Counter for the number of assumptions that occurred during testing. */
 } fossil_env_t;
@@ -261,13 +326,55 @@ extern xassert_info _ASSERT_INFO;
 // Function prototypes
 fossil_env_t fossil_test_environment_create(int argc, char **argv);
 void fossil_test_environment_run(fossil_env_t *env);
+void fossil_test_environment_algorithms(fossil_env_t *env);
+void fossil_test_run_testcase(fossil_test_t *test);
 void fossil_test_environment_add(fossil_env_t *env, fossil_test_t *test, fossil_fixture_t *fixture);
+void fossil_test_environment_group(fossil_env_t *env, const char *group_name);
 int  fossil_test_environment_summary(void);
 
 void fossil_test_apply_mark(fossil_test_t *test, const char *mark);
 void fossil_test_apply_xtag(fossil_test_t *test, const char *tag);
 void fossil_test_apply_priority(fossil_test_t *test, const char *priority);
 
+/**
+ * @brief Allocate memory from the test arena.
+ *
+ * Memory is carved from the current block and is only released when the arena
+ * is erased. Returned pointers are aligned for any fundamental type.
+ *
+ * @param arena The arena to allocate from.
+ * @param size The number of bytes requested.
+ * @return Pointer to the memory, or xnull if the heap is exhausted.
+ */
+void *fossil_test_arena_alloc(fossil_test_arena_t *arena, size_t size);
+
+/**
+ * @brief Copy a string into the test arena.
+ *
+ * @param arena The arena to allocate from.
+ * @param str The string to copy.
+ * @return Pointer to the copy, or xnull on failure.
+ */
+char *fossil_test_arena_strdup(fossil_test_arena_t *arena, const char *str);
+
+/**
+ * @brief Release every block owned by the test arena.
+ *
+ * @param arena The arena to erase.
+ */
+void fossil_test_arena_erase(fossil_test_arena_t *arena);
+
+/**
+ * @brief Get the number of heap allocations made by the test runner.
+ *
+ * Every allocation the runner makes for its own bookkeeping goes through one
+ * counted path. Once all tests are registered this number should stay flat for
+ * the rest of the run.
+ *
+ * @return The number of heap allocations made so far.
+ */
+size_t fossil_test_heap_allocs(void);
+
 /**
  * @brief Internal function for handling test assertions.
  * 
@@ -280,6 +387,31 @@ void fossil_test_apply_priority(fossil_test_t *test, const char *priority);
  */
 void _fossil_test_assert_class(bool expression, xassert_type_t behavior, char* message, char* file, int line, char* func);
 
+/**
+ * @brief Internal function comparing two buffers for an assertion.
+ *
+ * Records both buffers as the operands of the next assertion so a failure can
+ * be shown as a side-by-side hexdump.
+ *
+ * @param actual The actual buffer.
+ * @param expected The expected buffer.
+ * @param size The number of bytes to compare.
+ * @return True when both buffers hold the same bytes.
+ */
+bool _fossil_test_compare_bytes(const void *actual, const void *expected, size_t size);
+
+/**
+ * @brief Internal function comparing two strings for an assertion.
+ *
+ * Records both strings as the operands of the next assertion so a failure can
+ * be shown as a side-by-side text diff.
+ *
+ * @param actual The actual string.
+ * @param expected The expected string.
+ * @return True when both strings are equal.
+ */
+bool _fossil_test_compare_text(const char *actual, const char *expected);
+
 
 /**
  * @brief Macro to apply a priority to a test case.
@@ -383,6 +515,8 @@ void _fossil_test_assert_class(bool expression, xassert_type_t behavior, char* m
     void name##_fossil_test(void);  \
     fossil_test_t name = {          \
         (char*)#name,               \
+        xnull,                      \
+        xnull,                      \
         name##_fossil_test,         \
         (char*)"fossil",            \
         (char*)"fossil",            \
@@ -390,6 +524,7 @@ void _fossil_test_assert_class(bool expression, xassert_type_t behavior, char* m
         {xnull, xnull},             \
         0,                          \
         xnull,                      \
+        xnull,                      \
         xnull                       \
     };                              \
     void name##_fossil_test(void)
@@ -455,7 +590,7 @@ void _fossil_test_assert_class(bool expression, xassert_type_t behavior, char* m
  * 
  * @param group_name The name of the test group.
  */
-#define _FOSSIL_TEST_IMPORT(group_name) group_name(&_TEST_ENV)
+#define _FOSSIL_TEST_IMPORT(group_name) (fossil_test_environment_group(&_TEST_ENV, #group_name), group_name(&_TEST_ENV))
 
 #define _GIVEN(description) fossil_test_io_unittest_given(description); if (true)
 #define _WHEN(description) fossil_test_io_unittest_when(description);   if (true)
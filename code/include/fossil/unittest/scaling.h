@@ -0,0 +1,100 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FOSSIL_TEST_SCALING_H
+#define FOSSIL_TEST_SCALING_H
+
+#include "fossil/_common/common.h"
+#include "fossil/unittest/benchmark.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+enum {
+    FOSSIL_BENCH_SCALING_POINTS = 16,       // thread counts a scaling benchmark can measure
+    FOSSIL_BENCH_SCALING_ROUNDS = 7,        // timed rounds per thread count
+    FOSSIL_BENCH_SCALING_ROUND_NS = 10000000 // calibration target for one round on one thread (10 ms)
+};
+
+/**
+ * Structure holding the result of a scaling benchmark at one thread count.
+ */
+typedef struct {
+    int32_t threads;       /**< Threads running the body at once. */
+    double ops_per_second; /**< Iterations per second over all threads, median over the rounds. */
+    double latency_ns;     /**< Time per iteration seen by one thread, median over the rounds. */
+    double efficiency;     /**< Throughput divided by threads times the single thread throughput. */
+    double p99_ns;         /**< 99th percentile latency of one operation over all threads, 0 when none are recorded. */
+} fossil_bench_scaling_point_t;
+
+/**
+ * Structure representing a benchmark defined with FOSSIL_BENCH_THREADS. The body
+ * runs on 1, 2, 4 and so on up to the number of CPUs, or `bench-threads`. Every
+ * thread gets its own copy of the benchmark handle, with thread_index and
+ * thread_count set, and all of them start the timed loop together at a
+ * barrier. Each round runs the iteration count calibrated on one thread.
+ * Latencies are recorded by every thread into a histogram of its own, and the
+ * histograms are merged per thread count; the one kept is that of the most
+ * threads.
+ */
+struct fossil_bench_scaling_t {
+    fossil_bench_t bench;                                             /**< Name, body and calibrated iterations. */
+    int32_t point_count;                                              /**< Number of thread counts measured. */
+    fossil_bench_scaling_point_t points[FOSSIL_BENCH_SCALING_POINTS]; /**< Result of every thread count. */
+    fossil_bench_scaling_t *next;                                     /**< Next scaling benchmark that ran. */
+};
+
+/**
+ * Function to run a benchmark on a growing number of threads and report the
+ * scaling table through the runner.
+ *
+ * @param scaling The scaling benchmark to run.
+ * @param name The name of the benchmark.
+ * @param function The body, run by every thread at once. Assertions inside it
+ *                 are not thread safe.
+ */
+void fossil_bench_run_threads(fossil_bench_scaling_t *scaling, const char *name, fossil_bench_function_t function);
+
+/**
+ * @brief Macro to define a benchmark that is run on a growing number of threads.
+ *
+ * @param name The name of the benchmark.
+ */
+#define _FOSSIL_BENCH_THREADS(name)                                            \
+    void name##_fossil_bench(fossil_bench_t *bench);                          \
+    fossil_bench_scaling_t name##_xscaling;                                   \
+    void name##_fossil_test(void) {                                           \
+        fossil_bench_run_threads(&name##_xscaling, #name, name##_fossil_bench); \
+    }                                                                         \
+    fossil_test_t name = {                                                    \
+        (char*)#name,                                                         \
+        xnull,                                                                \
+        xnull,                                                                \
+        name##_fossil_test,                                                   \
+        (char*)"performance",                                                 \
+        (char*)"fossil",                                                      \
+        {0, 0, 0, {0, 0, 0, 0, 0}},                                           \
+        {xnull, xnull},                                                       \
+        0,                                                                    \
+        &name##_xscaling.bench,                                               \
+        xnull,                                                                \
+        xnull                                                                 \
+    };                                                                        \
+    void name##_fossil_bench(fossil_bench_t *bench)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,133 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FOSSIL_TEST_STARTUP_H
+#define FOSSIL_TEST_STARTUP_H
+
+#include "fossil/_common/common.h"
+#include "fossil/unittest/benchmark.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Entry point of a process startup benchmark, run in a freshly forked child.
+ *
+ * @return The exit status of the child, anything but 0 fails the benchmark.
+ */
+typedef int (*fossil_bench_entry_t)(void);
+
+/**
+ * Function to benchmark how long a command takes to start. Every sample forks
+ * and execs the command once, and is timed until the command exits or, when a
+ * marker is given, until the marker shows up on its standard output. The
+ * command runs in a process group of its own, which is killed once it is
+ * ready, so whatever it started goes with it; this is not timed. One start
+ * warms up, then every start is one sample and the usual statistics, baseline
+ * and gate apply. The benchmark fails when the command cannot be started,
+ * exits with a status other than 0, exits before writing the marker or is
+ * neither ready nor done within 30 seconds, when it is killed. Not supported on
+ * Windows, where there is no fork.
+ *
+ * @param bench The benchmark to run.
+ * @param name The name of the benchmark.
+ * @param argv The command and its arguments, terminated by xnull. The command
+ *             is looked up in PATH.
+ * @param marker Text the command writes once it is ready, xnull to time it to its exit.
+ */
+void fossil_bench_run_startup(fossil_bench_t *bench, const char *name, const char *const *argv, const char *marker);
+
+/**
+ * Function to benchmark a cold start of code in this program. Every sample
+ * forks a child that calls the entry point and exits with what it returns, so
+ * each start sees a fresh copy of the process with nothing run yet. A sample
+ * is timed until the child exits, or until the entry point calls
+ * fossil_bench_startup_ready. As for commands, the child gets a process group
+ * of its own that is killed afterwards, and is given 30 seconds.
+ *
+ * @param bench The benchmark to run.
+ * @param name The name of the benchmark.
+ * @param entry The entry point run in every child.
+ */
+void fossil_bench_run_entry(fossil_bench_t *bench, const char *name, fossil_bench_entry_t entry);
+
+/**
+ * Function for an entry point to tell the benchmark it is ready. The sample
+ * ends here, the child is then killed. Does nothing outside a child of
+ * fossil_bench_run_entry.
+ */
+void fossil_bench_startup_ready(void);
+
+/**
+ * @brief Macro to define a benchmark of the startup of a command.
+ *
+ * @param name The name of the benchmark.
+ * @param marker Text the command writes once it is ready, xnull to time it to its exit.
+ * @param ... The command and its arguments.
+ */
+#define _FOSSIL_BENCH_STARTUP(name, marker, ...)                               \
+    const char *const name##_xargv[] = { __VA_ARGS__, xnull };                \
+    fossil_bench_t name##_xbench;                                             \
+    void name##_fossil_test(void) {                                           \
+        fossil_bench_run_startup(&name##_xbench, #name, name##_xargv, (marker)); \
+    }                                                                         \
+    fossil_test_t name = {                                                    \
+        (char*)#name,                                                         \
+        xnull,                                                                \
+        xnull,                                                                \
+        name##_fossil_test,                                                   \
+        (char*)"performance",                                                 \
+        (char*)"fossil",                                                      \
+        {0, 0, 0, {0, 0, 0, 0, 0}},                                           \
+        {xnull, xnull},                                                       \
+        0,                                                                    \
+        &name##_xbench,                                                       \
+        xnull,                                                                \
+        xnull                                                                 \
+    }
+
+/**
+ * @brief Macro to define a benchmark of an entry point run in a fresh child.
+ *
+ * @param name The name of the benchmark.
+ */
+#define _FOSSIL_BENCH_ENTRY(name)                                              \
+    int name##_fossil_entry(void);                                            \
+    fossil_bench_t name##_xbench;                                             \
+    void name##_fossil_test(void) {                                           \
+        fossil_bench_run_entry(&name##_xbench, #name, name##_fossil_entry);   \
+    }                                                                         \
+    fossil_test_t name = {                                                    \
+        (char*)#name,                                                         \
+        xnull,                                                                \
+        xnull,                                                                \
+        name##_fossil_test,                                                   \
+        (char*)"performance",                                                 \
+        (char*)"fossil",                                                      \
+        {0, 0, 0, {0, 0, 0, 0, 0}},                                           \
+        {xnull, xnull},                                                       \
+        0,                                                                    \
+        &name##_xbench,                                                       \
+        xnull,                                                                \
+        xnull                                                                 \
+    };                                                                        \
+    int name##_fossil_entry(void)
+
+#define _FOSSIL_BENCH_READY() fossil_bench_startup_ready()
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,119 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FOSSIL_TEST_TRACE_H
+#define FOSSIL_TEST_TRACE_H
+
+#include "fossil/_common/common.h"
+#include "fossil/unittest/benchmark.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+enum {
+    FOSSIL_TEST_TRACE_CHUNK = 1024, // spans per buffer chunk, chunks are added as a thread fills them
+    FOSSIL_TEST_TRACE_STEPS = 3     // GIVEN, WHEN and THEN nesting levels
+};
+
+/**
+ * Structure representing one finished span of the trace. Names are not
+ * copied, they must live until the trace is written.
+ */
+typedef struct {
+    const char *category; /**< What ran: setup, test, teardown, given, when, then or bench. */
+    const char *name;     /**< Name of the case, step or benchmark. */
+    int32_t worker;       /**< Worker of a scaling benchmark, 0 for the runner itself. */
+    uint64_t begin_ns;    /**< Start on the monotonic clock. */
+    uint64_t end_ns;      /**< End on the monotonic clock. */
+} fossil_test_trace_span_t;
+
+/**
+ * Structure holding the trace state checked on every span. When the trace
+ * is off, recording a span costs the one branch on enabled.
+ */
+typedef struct {
+    bool enabled;       /**< Spans are being recorded. */
+    uint64_t origin_ns; /**< Monotonic time the trace started at, timestamps are relative to it. */
+} fossil_test_trace_t;
+
+extern fossil_test_trace_t _TEST_TRACE;
+
+/**
+ * Function to start recording spans into per thread buffers.
+ */
+void fossil_test_trace_start(void);
+
+/**
+ * Function to write every recorded span in the Chrome trace event format,
+ * which chrome://tracing and Perfetto open, then free the buffers and stop.
+ *
+ * @param path The file to write.
+ * @return True when the file was written.
+ */
+bool fossil_test_trace_save(const char *path);
+
+/**
+ * Function to add a finished span to the buffer of the calling thread.
+ *
+ * @param category What ran.
+ * @param name Name of what ran.
+ * @param worker Worker of a scaling benchmark, 0 otherwise.
+ * @param begin_ns Start on the monotonic clock.
+ * @param end_ns End on the monotonic clock.
+ */
+void fossil_test_trace_record(const char *category, const char *name, int32_t worker, uint64_t begin_ns, uint64_t end_ns);
+
+/**
+ * Function to open a GIVEN, WHEN or THEN step on the calling thread. The step
+ * ends when a step of the same or an outer level opens, or at the end of the
+ * test body.
+ *
+ * @param level 0 for GIVEN, 1 for WHEN and 2 for THEN.
+ * @param description The description of the step.
+ */
+void fossil_test_trace_step(int32_t level, const char *description);
+
+/**
+ * Function to end every open step of the calling thread.
+ */
+void fossil_test_trace_steps_close(void);
+
+/**
+ * Function to read the start of a span.
+ *
+ * @return The monotonic time, 0 when the trace is off.
+ */
+static inline uint64_t fossil_test_trace_begin(void) {
+    return _TEST_TRACE.enabled ? fossil_test_clock_ns() : 0;
+}
+
+/**
+ * Function to end a span started with fossil_test_trace_begin.
+ *
+ * @param category What ran.
+ * @param name Name of what ran.
+ * @param worker Worker of a scaling benchmark, 0 otherwise.
+ * @param begin_ns The value fossil_test_trace_begin returned.
+ */
+static inline void fossil_test_trace_end(const char *category, const char *name, int32_t worker, uint64_t begin_ns) {
+    if (_TEST_TRACE.enabled) {
+        fossil_test_trace_record(category, name, worker, begin_ns, fossil_test_clock_ns());
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,110 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#ifndef FOSSIL_TEST_WORKINGSET_H
+#define FOSSIL_TEST_WORKINGSET_H
+
+#include "fossil/_common/common.h"
+#include "fossil/unittest/benchmark.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+enum {
+    FOSSIL_BENCH_WORKING_SET_LEVELS = 3 // L1 data, L2 and L3
+};
+
+/**
+ * Structure holding the two sizes a working set benchmark ran at around one
+ * cache level: three quarters of the cache, which stays resident, and twice
+ * the cache, which does not.
+ */
+typedef struct {
+    int32_t level;         /**< Cache level, 1 to 3. */
+    size_t cache_bytes;    /**< Size of the cache, 0 when the level is unknown and was skipped. */
+    fossil_bench_t *below; /**< Benchmark of the working set that fits, arg holds its size in bytes. */
+    fossil_bench_t *above; /**< Benchmark of the working set that does not fit, xnull when memory is too small. */
+} fossil_bench_working_set_level_t;
+
+/**
+ * Structure representing a benchmark defined with FOSSIL_BENCH_WORKING_SET.
+ * The cache sizes of the host are detected at run time, and the body runs on
+ * working sets just below and above every level, so the point where a data
+ * structure falls out of a cache shows on any machine. Every size is sampled
+ * as a benchmark of its own named "name/<KiB>K".
+ *
+ * The body gets the size in bytes in bench->arg and a buffer of that size in
+ * bench->working_set, aligned to a cache line. The buffer holds a random cycle
+ * through all of its cache lines: the first pointer of every line points to
+ * the next line, so following it visits every line once in an order the
+ * prefetchers cannot guess. The body may overwrite it.
+ */
+struct fossil_bench_working_set_t {
+    fossil_bench_t bench;                                                     /**< Name and body shared by every size. */
+    size_t line_size;                                                         /**< Cache line size the buffers are laid out for. */
+    fossil_bench_working_set_level_t levels[FOSSIL_BENCH_WORKING_SET_LEVELS]; /**< Sizes measured around every level. */
+    fossil_bench_working_set_t *next;                                         /**< Next working set benchmark that ran. */
+};
+
+/**
+ * Function to run a benchmark on working sets below and above every cache
+ * level of the host, and report the slowdown at each level.
+ *
+ * @param working_set The working set benchmark to run.
+ * @param name The name of the benchmark.
+ * @param function The body of the benchmark, it reads bench->arg and bench->working_set.
+ */
+void fossil_bench_run_working_set(fossil_bench_working_set_t *working_set, const char *name, fossil_bench_function_t function);
+
+/**
+ * Function to follow the cycle a working set buffer is laid out with.
+ *
+ * @param start The line to start from, the buffer itself to begin with.
+ * @param steps The number of lines to visit.
+ * @return The line reached, pass it back in to carry on.
+ */
+void *fossil_bench_working_set_chase(void *start, uint64_t steps);
+
+/**
+ * @brief Macro to define a benchmark over working sets around every cache level.
+ *
+ * @param name The name of the benchmark.
+ */
+#define _FOSSIL_BENCH_WORKING_SET(name)                                        \
+    void name##_fossil_bench(fossil_bench_t *bench);                          \
+    fossil_bench_working_set_t name##_xworking_set;                           \
+    void name##_fossil_test(void) {                                           \
+        fossil_bench_run_working_set(&name##_xworking_set, #name, name##_fossil_bench); \
+    }                                                                         \
+    fossil_test_t name = {                                                    \
+        (char*)#name,                                                         \
+        xnull,                                                                \
+        xnull,                                                                \
+        name##_fossil_test,                                                   \
+        (char*)"performance",                                                 \
+        (char*)"fossil",                                                      \
+        {0, 0, 0, {0, 0, 0, 0, 0}},                                           \
+        {xnull, xnull},                                                       \
+        0,                                                                    \
+        &name##_xworking_set.bench,                                           \
+        xnull,                                                                \
+        xnull                                                                 \
+    };                                                                        \
+    void name##_fossil_bench(fossil_bench_t *bench)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
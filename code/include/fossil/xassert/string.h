@@ -36,7 +36,7 @@ extern "C"
 
 // Byte string equality check
 #define ASSERT_ITS_EQUAL_BSTR(actual, expected) \
-    TEST_ASSERT(strcmp((const char*)(actual), (const char*)(expected)) == 0, "Expected byte string " #actual " to be equal to " #expected)
+    TEST_ASSERT(_fossil_test_compare_text((const char*)(actual), (const char*)(expected)), "Expected byte string " #actual " to be equal to " #expected)
 
 #define ASSERT_NOT_EQUAL_BSTR(actual, expected) \
     TEST_ASSERT(strcmp((const char*)(actual), (const char*)(expected)) != 0, "Expected byte string " #actual " to not be equal to " #expected)
@@ -47,7 +47,7 @@ extern "C"
 
 // Classic C string equality check
 #define ASSERT_ITS_EQUAL_CSTR(actual, expected) \
-    TEST_ASSERT(strcmp((actual), (expected)) == 0, "Expected C string " #actual " to be equal to " #expected)
+    TEST_ASSERT(_fossil_test_compare_text((actual), (expected)), "Expected C string " #actual " to be equal to " #expected)
 
 #define ASSERT_NOT_EQUAL_CSTR(actual, expected) \
     TEST_ASSERT(strcmp((actual), (expected)) != 0, "Expected C string " #actual " to not be equal to " #expected)
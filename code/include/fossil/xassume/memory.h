@@ -65,6 +65,15 @@ extern "C"
 #define ASSUME_NOT_EQUAL_SIZE(actual, expected) \
     TEST_ASSUME((size_t)(actual) != (size_t)(expected), "Expected " #actual " to not be equal to " #expected)
 
+// Memory block assertions (_MEM), failures show a hexdump of both sides
+
+// ITS set
+#define ASSUME_ITS_EQUAL_MEM(actual, expected, size) \
+    TEST_ASSUME(_fossil_test_compare_bytes((actual), (expected), (size)), "Expected memory at " #actual " to be equal to memory at " #expected)
+
+#define ASSUME_NOT_EQUAL_MEM(actual, expected, size) \
+    TEST_ASSUME(!_fossil_test_compare_bytes((actual), (expected), (size)), "Expected memory at " #actual " to not be equal to memory at " #expected)
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,156 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/unittest/allocs.h"
+
+// ==============================================================================
+// Xmark allocator hooks, built as the fossil-test-allochook library
+// ==============================================================================
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#include <errno.h>
+#include <stdatomic.h>
+
+// Entry points of the glibc allocator, the wrappers below forward to them
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void *__libc_valloc(size_t size);
+extern void *__libc_pvalloc(size_t size);
+extern void __libc_free(void *ptr);
+
+//
+// local types
+//
+
+static atomic_int allocs_scopes;
+static atomic_uint_fast64_t allocs_count;
+static atomic_uint_fast64_t allocs_frees;
+static atomic_uint_fast64_t allocs_bytes;
+static atomic_int_fast64_t allocs_live;
+static atomic_int_fast64_t allocs_peak;
+
+static inline bool allocs_counting(void) {
+    return atomic_load_explicit(&allocs_scopes, memory_order_relaxed) > 0;
+}
+
+// Moves the live byte count and keeps the highest value seen
+static void allocs_move(int64_t delta) {
+    int64_t live = (int64_t)atomic_fetch_add_explicit(&allocs_live, delta, memory_order_relaxed) + delta;
+    int64_t peak = (int64_t)atomic_load_explicit(&allocs_peak, memory_order_relaxed);
+    while (live > peak && !atomic_compare_exchange_weak_explicit(&allocs_peak, &peak, live,
+        memory_order_relaxed, memory_order_relaxed)) {
+        // peak was reloaded, try again
+    }
+}
+
+static void *allocs_note(void *ptr, size_t size) {
+    if (ptr != xnullptr && allocs_counting()) {
+        atomic_fetch_add_explicit(&allocs_count, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&allocs_bytes, size, memory_order_relaxed);
+        allocs_move((int64_t)malloc_usable_size(ptr));
+    }
+    return ptr;
+}
+
+void *malloc(size_t size) {
+    return allocs_note(__libc_malloc(size), size);
+}
+
+void *calloc(size_t count, size_t size) {
+    return allocs_note(__libc_calloc(count, size), count * size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    if (!allocs_counting()) {
+        return __libc_realloc(ptr, size);
+    }
+    int64_t before = ptr != xnullptr ? (int64_t)malloc_usable_size(ptr) : 0;
+    void *moved = __libc_realloc(ptr, size);
+    if (moved != xnullptr) {
+        atomic_fetch_add_explicit(&allocs_count, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&allocs_bytes, size, memory_order_relaxed);
+        if (ptr != xnullptr) {
+            atomic_fetch_add_explicit(&allocs_frees, 1, memory_order_relaxed);
+        }
+        allocs_move((int64_t)malloc_usable_size(moved) - before);
+    } else if (ptr != xnullptr && size == 0) {
+        atomic_fetch_add_explicit(&allocs_frees, 1, memory_order_relaxed);
+        allocs_move(-before);
+    }
+    return moved;
+}
+
+void *reallocarray(void *ptr, size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return xnullptr;
+    }
+    return realloc(ptr, count * size);
+}
+
+// The aligned allocators are wrapped too, their blocks are freed with free
+void *memalign(size_t alignment, size_t size) {
+    return allocs_note(__libc_memalign(alignment, size), size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    return allocs_note(__libc_memalign(alignment, size), size);
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size) {
+    if (alignment == 0 || alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void *ptr = __libc_memalign(alignment, size);
+    if (ptr == xnullptr) {
+        return ENOMEM;
+    }
+    *out = allocs_note(ptr, size);
+    return 0;
+}
+
+void *valloc(size_t size) {
+    return allocs_note(__libc_valloc(size), size);
+}
+
+void *pvalloc(size_t size) {
+    return allocs_note(__libc_pvalloc(size), size);
+}
+
+void free(void *ptr) {
+    if (ptr != xnullptr && allocs_counting()) {
+        atomic_fetch_add_explicit(&allocs_frees, 1, memory_order_relaxed);
+        allocs_move(-(int64_t)malloc_usable_size(ptr));
+    }
+    __libc_free(ptr);
+}
+
+void fossil_test_allochook_scope(int32_t delta) {
+    atomic_fetch_add(&allocs_scopes, delta);
+}
+
+void fossil_test_allochook_reset_peak(void) {
+    atomic_store(&allocs_peak, atomic_load(&allocs_live));
+}
+
+void fossil_test_allochook_read(fossil_test_allochook_totals_t *totals) {
+    totals->allocs = atomic_load(&allocs_count);
+    totals->frees = atomic_load(&allocs_frees);
+    totals->bytes = atomic_load(&allocs_bytes);
+    totals->live = atomic_load(&allocs_live);
+    totals->peak = atomic_load(&allocs_peak);
+}
+
+#endif
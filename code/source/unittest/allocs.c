@@ -0,0 +1,93 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/unittest/allocs.h"
+
+// ==============================================================================
+// Xmark functions for allocation counting
+// ==============================================================================
+
+// The hooks live in the fossil-test-allochook library, so only programs that
+// link or preload it on purpose get their allocator wrapped. Its entry points
+// are weak here and stay null without it.
+#if defined(__GNUC__) && defined(__ELF__)
+#pragma weak fossil_test_allochook_scope
+#pragma weak fossil_test_allochook_reset_peak
+#pragma weak fossil_test_allochook_read
+
+bool fossil_test_allocs_available(void) {
+    return fossil_test_allochook_read != xnullptr;
+}
+
+void fossil_test_allocs_begin(fossil_test_allocs_t *scope) {
+    memset(scope, 0, sizeof(*scope));
+    scope->open = true;
+    if (!fossil_test_allocs_available()) {
+        return;
+    }
+    fossil_test_allochook_totals_t totals;
+    fossil_test_allochook_read(&totals);
+    scope->begin_allocs = totals.allocs;
+    scope->begin_frees = totals.frees;
+    scope->begin_bytes = totals.bytes;
+    scope->begin_live = totals.live;
+    fossil_test_allochook_reset_peak();
+    fossil_test_allochook_scope(1);
+}
+
+void fossil_test_allocs_end(fossil_test_allocs_t *scope) {
+    if (!scope->open) {
+        return;
+    }
+    scope->open = false;
+    if (!fossil_test_allocs_available()) {
+        return;
+    }
+    fossil_test_allochook_scope(-1);
+    fossil_test_allochook_totals_t totals;
+    fossil_test_allochook_read(&totals);
+    scope->valid = true;
+    scope->allocs = totals.allocs - scope->begin_allocs;
+    scope->frees = totals.frees - scope->begin_frees;
+    scope->bytes = totals.bytes - scope->begin_bytes;
+    scope->peak_bytes = totals.peak - scope->begin_live;
+}
+
+#else
+
+bool fossil_test_allocs_available(void) {
+    return false;
+}
+
+void fossil_test_allocs_begin(fossil_test_allocs_t *scope) {
+    memset(scope, 0, sizeof(*scope));
+    scope->open = true;
+}
+
+void fossil_test_allocs_end(fossil_test_allocs_t *scope) {
+    scope->open = false;
+}
+
+#endif
+
+void fossil_test_allocs_accumulate(fossil_test_allocs_t *total, const fossil_test_allocs_t *scope) {
+    if (!scope->valid) {
+        return;
+    }
+    total->valid = true;
+    total->allocs += scope->allocs;
+    total->frees += scope->frees;
+    total->bytes += scope->bytes;
+    if (scope->peak_bytes > total->peak_bytes) {
+        total->peak_bytes = scope->peak_bytes;
+    }
+}
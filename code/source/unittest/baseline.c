@@ -0,0 +1,474 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/unittest/baseline.h"
+#include "fossil/unittest/console.h"
+#include "fossil/unittest/commands.h"
+#include "fossil/unittest/host.h"
+#include <math.h>
+
+// ==============================================================================
+// Xmark functions for benchmark baselines
+// ==============================================================================
+
+//
+// local types
+//
+
+#define BASELINE_MAGIC "fossil-bench 1"
+#define BASELINE_ALPHA 0.05
+#define BASELINE_Z95 1.959964 // two sided 95% quantile of the normal distribution
+#define BASELINE_HOST_MAX 1024 // longest host line kept, the same as a read line
+
+// One sample of either set, ranked together by the U test
+typedef struct {
+    double value;
+    bool current;
+} ranked_sample_t;
+
+// Baseline given with bench-compare, read on first use
+static fossil_bench_record_t *baseline_records = xnullptr;
+static bool baseline_loaded = false;
+
+// Previous run kept in the bench-save file, read before this run overwrites it
+static fossil_bench_record_t *history_records = xnullptr;
+static bool history_loaded = false;
+
+bool fossil_bench_save(const char *path, const fossil_bench_t *benches) {
+    FILE *file = fopen(path, "w");
+    if (file == xnullptr) {
+        return false;
+    }
+    char host[512];
+    fossil_bench_host_describe(host, sizeof(host));
+    fprintf(file, "%s\n", BASELINE_MAGIC);
+    fprintf(file, "host%s\n", host);
+    for (const fossil_bench_t *bench = benches; bench != xnullptr; bench = bench->next) {
+        fprintf(file, "bench %s iterations %llu", bench->name, (unsigned long long)bench->iterations);
+        if (bench->alloc_iterations > 0) {
+            fprintf(file, " allocs %.6g bytes %.6g", (double)bench->allocs.allocs / (double)bench->alloc_iterations,
+                (double)bench->allocs.bytes / (double)bench->alloc_iterations);
+        }
+        if (bench->processed_bytes.per_iteration > 0) {
+            fprintf(file, " processed_bytes %llu bytes_per_second %.6g", (unsigned long long)bench->processed_bytes.per_iteration,
+                bench->processed_bytes.median);
+        }
+        if (bench->processed_items.per_iteration > 0) {
+            fprintf(file, " processed_items %llu items_per_second %.6g", (unsigned long long)bench->processed_items.per_iteration,
+                bench->processed_items.median);
+        }
+        fprintf(file, " samples %d", bench->sample_count);
+        for (int32_t i = 0; i < bench->sample_count; i++) {
+            fprintf(file, " %.6g", bench->samples[i]);
+        }
+        fputc('\n', file);
+    }
+    return fclose(file) == 0;
+}
+
+// Reads the key and value pairs of one "bench" line into the record
+static bool baseline_parse(char *line, fossil_bench_record_t *record) {
+    char key[32];
+    int used = 0;
+    if (sscanf(line, "bench %127s%n", record->name, &used) != 1) {
+        return false;
+    }
+    line += used;
+    while (sscanf(line, " %31s%n", key, &used) == 1) {
+        line += used;
+        if (strcmp(key, "samples") == 0) {
+            int count = 0;
+            if (sscanf(line, " %d%n", &count, &used) != 1 || count < 0 || count > FOSSIL_BENCH_MAX_SAMPLES) {
+                return false;
+            }
+            line += used;
+            for (record->sample_count = 0; record->sample_count < count; record->sample_count++) {
+                if (sscanf(line, " %lf%n", &record->samples[record->sample_count], &used) != 1) {
+                    return false;
+                }
+                line += used;
+            }
+        } else if (strcmp(key, "iterations") == 0 || strcmp(key, "processed_bytes") == 0 || strcmp(key, "processed_items") == 0) {
+            unsigned long long count = 0;
+            if (sscanf(line, " %llu%n", &count, &used) != 1) {
+                return false;
+            }
+            if (strcmp(key, "iterations") == 0) {
+                record->iterations = (uint64_t)count;
+            } else if (strcmp(key, "processed_bytes") == 0) {
+                record->processed_bytes = (uint64_t)count;
+            } else {
+                record->processed_items = (uint64_t)count;
+            }
+            line += used;
+        } else if (strcmp(key, "allocs") == 0 || strcmp(key, "bytes") == 0) {
+            double value = 0.0;
+            if (sscanf(line, " %lf%n", &value, &used) != 1) {
+                return false;
+            }
+            if (strcmp(key, "allocs") == 0) {
+                record->allocs = value;
+            } else {
+                record->bytes = value;
+            }
+            record->has_allocs = true;
+            line += used;
+        } else {
+            used = 0;
+            sscanf(line, " %*s%n", &used); // value of a key this version does not know
+            line += used;
+        }
+    }
+    return record->sample_count > 0;
+}
+
+fossil_bench_record_t *fossil_bench_load(const char *path, fossil_test_arena_t *arena, bool *ok) {
+    static char line[16384];
+    fossil_bench_record_t *head = xnullptr;
+    fossil_bench_record_t **tail = &head;
+    *ok = false;
+
+    FILE *file = fopen(path, "r");
+    if (file == xnullptr) {
+        return xnullptr;
+    }
+    if (fgets(line, sizeof(line), file) == xnullptr || strncmp(line, BASELINE_MAGIC, strlen(BASELINE_MAGIC)) != 0) {
+        fclose(file);
+        return xnullptr;
+    }
+    while (fgets(line, sizeof(line), file) != xnullptr) {
+        if (strncmp(line, "bench ", 6) != 0) {
+            continue;
+        }
+        fossil_bench_record_t *record = (fossil_bench_record_t*)fossil_test_arena_alloc(arena, sizeof(*record));
+        if (record == xnullptr) {
+            break;
+        }
+        memset(record, 0, sizeof(*record));
+        if (baseline_parse(line, record)) {
+            *tail = record;
+            tail = &record->next;
+        }
+    }
+    fclose(file);
+    *ok = true;
+    return head;
+}
+
+const fossil_bench_record_t *fossil_bench_find(const fossil_bench_record_t *records, const char *name) {
+    for (; records != xnullptr; records = records->next) {
+        if (strcmp(records->name, name) == 0) {
+            return records;
+        }
+    }
+    return xnullptr;
+}
+
+uint64_t fossil_bench_history_ns(const fossil_bench_record_t *records, const char *name) {
+    size_t length = strlen(name);
+    double total = 0.0;
+    for (; records != xnullptr; records = records->next) {
+        if (strncmp(records->name, name, length) != 0 || (records->name[length] != '\0' && records->name[length] != '/')) {
+            continue;
+        }
+        for (int32_t i = 0; i < records->sample_count; i++) {
+            total += records->samples[i] * (double)records->iterations;
+        }
+    }
+    return (uint64_t)total;
+}
+
+static int ranked_compare(const void *lhs, const void *rhs) {
+    double a = ((const ranked_sample_t*)lhs)->value;
+    double b = ((const ranked_sample_t*)rhs)->value;
+    return (a > b) - (a < b);
+}
+
+double fossil_bench_mann_whitney(const double *baseline, int32_t baseline_count, const double *current, int32_t current_count, double *z) {
+    *z = 0.0;
+    if (baseline_count <= 0 || current_count <= 0) {
+        return 1.0;
+    }
+    int32_t total = baseline_count + current_count;
+    ranked_sample_t *ranked = (ranked_sample_t*)malloc((size_t)total * sizeof(*ranked));
+    if (ranked == xnullptr) {
+        return 1.0;
+    }
+    for (int32_t i = 0; i < baseline_count; i++) {
+        ranked[i].value = baseline[i];
+        ranked[i].current = false;
+    }
+    for (int32_t i = 0; i < current_count; i++) {
+        ranked[baseline_count + i].value = current[i];
+        ranked[baseline_count + i].current = true;
+    }
+    qsort(ranked, (size_t)total, sizeof(*ranked), ranked_compare);
+
+    // tied values share the average of their ranks
+    double rank_sum = 0.0;
+    double ties = 0.0;
+    for (int32_t i = 0; i < total;) {
+        int32_t j = i;
+        while (j < total && ranked[j].value == ranked[i].value) {
+            j++;
+        }
+        double rank = (double)(i + j + 1) / 2.0;
+        for (int32_t k = i; k < j; k++) {
+            if (ranked[k].current) {
+                rank_sum += rank;
+            }
+        }
+        double run = (double)(j - i);
+        ties += run * run * run - run;
+        i = j;
+    }
+    free(ranked);
+
+    double n1 = (double)current_count;
+    double n2 = (double)baseline_count;
+    double n = n1 + n2;
+    double u = rank_sum - n1 * (n1 + 1.0) / 2.0;
+    double mean = n1 * n2 / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1.0) - ties / (n * (n - 1.0)));
+    if (variance <= 0.0) {
+        return 1.0;
+    }
+    double distance = fabs(u - mean) - 0.5; // continuity correction
+    if (distance < 0.0) {
+        distance = 0.0;
+    }
+    *z = (u > mean ? distance : -distance) / sqrt(variance);
+    return erfc(fabs(*z) / sqrt(2.0));
+}
+
+static int double_compare(const void *lhs, const void *rhs) {
+    double a = *(const double*)lhs;
+    double b = *(const double*)rhs;
+    return (a > b) - (a < b);
+}
+
+// Shift between the two sets, read from the sorted differences of every pair
+// of samples: the median is the Hodges-Lehmann estimate and the distribution
+// free confidence interval around it is Moses'. The interval matches the U
+// test, it excludes 0 when the test rejects, and always holds the estimate.
+static void baseline_shift(const double *baseline, int32_t baseline_count, const double *current, int32_t current_count,
+    double *shift, double *low, double *high) {
+    *shift = 0.0;
+    *low = 0.0;
+    *high = 0.0;
+    if (baseline_count <= 0 || current_count <= 0) {
+        return;
+    }
+    size_t total = (size_t)baseline_count * (size_t)current_count;
+    double *differences = (double*)malloc(total * sizeof(*differences));
+    if (differences == xnullptr) {
+        return;
+    }
+    size_t used = 0;
+    for (int32_t i = 0; i < baseline_count; i++) {
+        for (int32_t j = 0; j < current_count; j++) {
+            differences[used++] = current[j] - baseline[i];
+        }
+    }
+    qsort(differences, total, sizeof(*differences), double_compare);
+
+    double n1 = (double)current_count;
+    double n2 = (double)baseline_count;
+    double rank = floor(n1 * n2 / 2.0 - BASELINE_Z95 * sqrt(n1 * n2 * (n1 + n2 + 1.0) / 12.0));
+    size_t k = rank < 1.0 ? 0 : (size_t)rank - 1;
+    *shift = total % 2 == 1 ? differences[total / 2] : (differences[total / 2 - 1] + differences[total / 2]) / 2.0;
+    *low = differences[k];
+    *high = differences[total - 1 - k];
+    free(differences);
+}
+
+void fossil_bench_compare(const double *baseline, int32_t baseline_count, const double *current, int32_t current_count,
+    double threshold, fossil_bench_compare_t *compare) {
+    fossil_bench_stats_t before;
+    double z = 0.0;
+    double shift = 0.0;
+    double low = 0.0;
+    double high = 0.0;
+    fossil_bench_stats(baseline, baseline_count, &before);
+    baseline_shift(baseline, baseline_count, current, current_count, &shift, &low, &high);
+
+    compare->baseline_median_ns = before.median_ns;
+    compare->delta = before.median_ns > 0.0 ? shift / before.median_ns : 0.0;
+    compare->delta_low = before.median_ns > 0.0 ? low / before.median_ns : 0.0;
+    compare->delta_high = before.median_ns > 0.0 ? high / before.median_ns : 0.0;
+    compare->p_value = fossil_bench_mann_whitney(baseline, baseline_count, current, current_count, &z);
+    compare->verdict = FOSSIL_BENCH_VERDICT_SAME;
+    if (compare->p_value < BASELINE_ALPHA && compare->delta > threshold && z > 0.0) {
+        compare->verdict = FOSSIL_BENCH_VERDICT_SLOWER;
+    } else if (compare->p_value < BASELINE_ALPHA && compare->delta < -threshold && z < 0.0) {
+        compare->verdict = FOSSIL_BENCH_VERDICT_FASTER;
+    }
+}
+
+// Reads the bench-compare baseline on first use, warns once when it cannot be read
+static const fossil_bench_record_t *baseline_compare_records(void) {
+    if (!baseline_loaded) {
+        bool ok = false;
+        baseline_loaded = true;
+        baseline_records = fossil_bench_load(_CLI.bench_compare_file, &_TEST_ENV.arena, &ok);
+        if (!ok) {
+            fossil_test_cout("yellow", "could not read benchmark baseline %s, nothing to compare against\n", _CLI.bench_compare_file);
+        }
+    }
+    return baseline_records;
+}
+
+const fossil_bench_record_t *fossil_bench_history(void) {
+    if (_CLI.bench_compare_file[0] != '\0') {
+        return baseline_compare_records();
+    }
+    if (_CLI.bench_save_file[0] != '\0' && !history_loaded) {
+        bool ok = false;
+        history_loaded = true;
+        history_records = fossil_bench_load(_CLI.bench_save_file, &_TEST_ENV.arena, &ok); // not there yet on the first run
+    }
+    return history_records;
+}
+
+void fossil_bench_gate(fossil_bench_t *bench) {
+    static char message[FOSSIL_BENCH_NAME_MAX + 96];
+    bench->compare.verdict = FOSSIL_BENCH_VERDICT_NONE;
+    if (_CLI.bench_compare_file[0] == '\0') {
+        return;
+    }
+    const fossil_bench_record_t *record = fossil_bench_find(baseline_compare_records(), bench->name);
+    if (record == xnullptr) {
+        return;
+    }
+    fossil_bench_compare(record->samples, record->sample_count, bench->samples, bench->sample_count,
+        _CLI.bench_threshold / 100.0, &bench->compare);
+    if (bench->compare.verdict == FOSSIL_BENCH_VERDICT_SLOWER) {
+        snprintf(message, sizeof(message), "benchmark %s is %.1f%% slower than its baseline (p = %.3g)",
+            bench->name, bench->compare.delta * 100.0, bench->compare.p_value);
+        _fossil_test_assert_class(false, TEST_ASSERT_AS_CLASS_EXPECT, message, (char*)__FILE__, __LINE__, (char*)__func__);
+    }
+}
+
+// Reads the "host" line of a baseline file, empty when it has none
+static void baseline_host(const char *path, char *out, size_t size) {
+    static char line[BASELINE_HOST_MAX];
+    out[0] = '\0';
+    FILE *file = fopen(path, "r");
+    if (file == xnullptr) {
+        return;
+    }
+    while (fgets(line, sizeof(line), file) != xnullptr) {
+        if (strncmp(line, "host", 4) == 0 && (line[4] == ' ' || line[4] == '\n')) {
+            line[strcspn(line, "\r\n")] = '\0';
+            snprintf(out, size, "%s", line[4] == ' ' ? line + 5 : "");
+            break;
+        }
+        if (strncmp(line, "bench ", 6) == 0) {
+            break; // the host line comes before the first benchmark
+        }
+    }
+    fclose(file);
+}
+
+// Rows with a change come first, largest change first, added and removed
+// benchmarks go last, equal rows by name.
+static int report_row_compare(const void *lhs, const void *rhs) {
+    const fossil_bench_report_row_t *a = (const fossil_bench_report_row_t*)lhs;
+    const fossil_bench_report_row_t *b = (const fossil_bench_report_row_t*)rhs;
+    bool a_both = a->before != xnullptr && a->after != xnullptr;
+    bool b_both = b->before != xnullptr && b->after != xnullptr;
+    if (a_both != b_both) {
+        return a_both ? -1 : 1;
+    }
+    double a_impact = fabs(a->compare.delta);
+    double b_impact = fabs(b->compare.delta);
+    if (a_both && a_impact != b_impact) {
+        return a_impact > b_impact ? -1 : 1;
+    }
+    return strcmp(a->name, b->name);
+}
+
+static double report_median(const fossil_bench_record_t *record) {
+    fossil_bench_stats_t stats;
+    if (record == xnullptr) {
+        return 0.0;
+    }
+    fossil_bench_stats(record->samples, record->sample_count, &stats);
+    return stats.median_ns;
+}
+
+int fossil_bench_report(const char *old_path, const char *new_path, bool json) {
+    fossil_test_arena_t arena = { xnullptr };
+    bool old_ok = false;
+    bool new_ok = false;
+    char old_host[BASELINE_HOST_MAX];
+    char new_host[BASELINE_HOST_MAX];
+    const fossil_bench_record_t *before = fossil_bench_load(old_path, &arena, &old_ok);
+    const fossil_bench_record_t *after = fossil_bench_load(new_path, &arena, &new_ok);
+    if (!old_ok || !new_ok) {
+        fossil_test_cout("red", "could not read benchmark results %s\n", !old_ok ? old_path : new_path);
+        fossil_test_arena_erase(&arena);
+        return 2;
+    }
+    baseline_host(old_path, old_host, sizeof(old_host));
+    baseline_host(new_path, new_host, sizeof(new_host));
+
+    int32_t count = 0;
+    for (const fossil_bench_record_t *record = after; record != xnullptr; record = record->next) {
+        count++;
+    }
+    for (const fossil_bench_record_t *record = before; record != xnullptr; record = record->next) {
+        count += fossil_bench_find(after, record->name) == xnullptr ? 1 : 0;
+    }
+    fossil_bench_report_row_t *rows = (fossil_bench_report_row_t*)fossil_test_arena_alloc(&arena,
+        (size_t)(count > 0 ? count : 1) * sizeof(*rows));
+    if (rows == xnullptr) {
+        fossil_test_arena_erase(&arena);
+        return 2;
+    }
+
+    // every benchmark of the new run, then those that only the old run has
+    int32_t used = 0;
+    for (const fossil_bench_record_t *record = after; record != xnullptr; record = record->next) {
+        fossil_bench_report_row_t *row = &rows[used++];
+        memset(row, 0, sizeof(*row));
+        row->name = record->name;
+        row->before = fossil_bench_find(before, record->name);
+        row->after = record;
+    }
+    for (const fossil_bench_record_t *record = before; record != xnullptr; record = record->next) {
+        if (fossil_bench_find(after, record->name) == xnullptr) {
+            fossil_bench_report_row_t *row = &rows[used++];
+            memset(row, 0, sizeof(*row));
+            row->name = record->name;
+            row->before = record;
+        }
+    }
+
+    int result = 0;
+    for (int32_t i = 0; i < count; i++) {
+        fossil_bench_report_row_t *row = &rows[i];
+        row->before_median_ns = report_median(row->before);
+        row->after_median_ns = report_median(row->after);
+        row->compare.verdict = FOSSIL_BENCH_VERDICT_NONE;
+        if (row->before != xnullptr && row->after != xnullptr) {
+            fossil_bench_compare(row->before->samples, row->before->sample_count, row->after->samples, row->after->sample_count,
+                _CLI.bench_threshold / 100.0, &row->compare);
+            result = row->compare.verdict == FOSSIL_BENCH_VERDICT_SLOWER ? 1 : result;
+        }
+    }
+    qsort(rows, (size_t)count, sizeof(*rows), report_row_compare);
+
+    fossil_test_io_bench_report(old_path, old_host, new_path, new_host, rows, count, json);
+    fossil_test_arena_erase(&arena);
+    return result;
+}
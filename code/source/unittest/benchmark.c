@@ -11,9 +11,21 @@ Description:
 ==============================================================================
 */
 #include "fossil/unittest/benchmark.h"
+#include "fossil/unittest/baseline.h"
 #include "fossil/unittest/internal.h"
 #include "fossil/unittest/console.h"
+#include "fossil/unittest/commands.h"
+#include "fossil/unittest/trace.h"
+#include "fossil/unittest/cold.h"
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <math.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+#if defined(FOSSIL_BENCH_CYCLES_X86) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
 
 // ==============================================================================
 // Xmark functions for benchmarks
@@ -22,87 +34,867 @@ Description:
 //
 // local types
 //
-static uint64_t start_time;
 
-#if defined(_WIN32)
-static double frequency; // Variable to store the frequency for Windows
-#endif
+// Timer behind TEST_BENCHMARK and the start/stop pair, one per thread
+static _Thread_local fossil_bench_timer_t thread_timer;
 
-void fossil_test_start_benchmark(void) {
+uint64_t fossil_test_clock_ns(void) {
 #if defined(_WIN32)
-    LARGE_INTEGER freq;
-    if (!QueryPerformanceFrequency(&freq)) {
-        // Handle error
-        fprintf(stderr, "Error: QueryPerformanceFrequency failed\n");
-        exit(EXIT_FAILURE);
-    }
-    frequency = (double)freq.QuadPart;
-    if (!QueryPerformanceCounter((LARGE_INTEGER*)&start_time)) {
-        // Handle error
-        fprintf(stderr, "Error: QueryPerformanceCounter failed\n");
-        exit(EXIT_FAILURE);
-    }
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
 #else
     struct timespec ts;
-    if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1) {
-        // Handle error
-        perror("Error: clock_gettime failed");
-        exit(EXIT_FAILURE);
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// ==============================================================================
+// Xmark benchmark clock
+// ==============================================================================
+
+enum {
+    BENCH_CALIBRATE_NS = 5000000, // spin used to measure the tick rate (5 ms)
+    BENCH_OVERHEAD_ROUNDS = 1000  // back to back reads used to measure the overhead
+};
+
+fossil_bench_clock_t _BENCH_CLOCK = { false, false, false, 1.0, 0, "monotonic" };
+
+// Checks for a cycle counter that ticks at a constant rate in every power state
+static bool bench_cycles_supported(bool *rdtscp) {
+    *rdtscp = false;
+#if defined(FOSSIL_BENCH_CYCLES_X86) && defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, (int)0x80000000);
+    if ((unsigned int)regs[0] < 0x80000007u) {
+        return false;
+    }
+    __cpuid(regs, (int)0x80000001);
+    *rdtscp = (regs[3] & (1 << 27)) != 0;
+    __cpuid(regs, (int)0x80000007);
+    return (regs[3] & (1 << 8)) != 0; // invariant TSC
+#elif defined(FOSSIL_BENCH_CYCLES_X86)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000000u, &eax, &ebx, &ecx, &edx) || eax < 0x80000007u) {
+        return false;
     }
-    start_time = ts.tv_sec * 1e9 + ts.tv_nsec;
+    __get_cpuid(0x80000001u, &eax, &ebx, &ecx, &edx);
+    *rdtscp = (edx & (1u << 27)) != 0;
+    __get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0; // invariant TSC
+#elif defined(FOSSIL_BENCH_CYCLES_ARM64)
+    return true; // the generic timer runs at a fixed frequency
+#else
+    return false;
 #endif
 }
 
-uint64_t fossil_test_stop_benchmark(void) {
-#if defined(_WIN32)
-    LARGE_INTEGER end_time;
-    if (!QueryPerformanceCounter(&end_time)) {
-        // Handle error
-        fprintf(stderr, "Error: QueryPerformanceCounter failed\n");
-        exit(EXIT_FAILURE);
+// Set with release once _BENCH_CLOCK is filled in, a timer on any thread
+// reads it with acquire before it trusts the tick rate
+static atomic_bool bench_clock_ready;
+
+static void bench_clock_measure(void) {
+    bool rdtscp = false;
+    _BENCH_CLOCK.cycles = bench_cycles_supported(&rdtscp);
+    _BENCH_CLOCK.rdtscp = false;
+    _BENCH_CLOCK.ns_per_tick = 1.0;
+    _BENCH_CLOCK.source = "monotonic";
+
+    if (_BENCH_CLOCK.cycles) {
+        uint64_t ns_start = fossil_test_clock_ns();
+        uint64_t ticks_start = fossil_bench_ticks_start();
+        uint64_t ns_end = ns_start;
+        while (ns_end - ns_start < BENCH_CALIBRATE_NS) {
+            ns_end = fossil_test_clock_ns();
+        }
+        uint64_t ticks_end = fossil_bench_ticks_start();
+
+        if (ticks_end > ticks_start) {
+            _BENCH_CLOCK.ns_per_tick = (double)(ns_end - ns_start) / (double)(ticks_end - ticks_start);
+            _BENCH_CLOCK.rdtscp = rdtscp;
+#if defined(FOSSIL_BENCH_CYCLES_X86)
+            _BENCH_CLOCK.source = rdtscp ? "rdtscp" : "rdtsc";
+#else
+            _BENCH_CLOCK.source = "cntvct";
+#endif
+        } else {
+            _BENCH_CLOCK.cycles = false; // counter did not move, stay on the monotonic clock
+        }
     }
-    return (uint64_t)((end_time.QuadPart - start_time) * 1e9 / frequency);
+
+    // the cheapest back to back pair is what every timed stretch pays
+    uint64_t overhead = UINT64_MAX;
+    for (int32_t i = 0; i < BENCH_OVERHEAD_ROUNDS; i++) {
+        uint64_t start = fossil_bench_ticks_start();
+        uint64_t stop = fossil_bench_ticks_stop();
+        if (stop - start < overhead) {
+            overhead = stop - start;
+        }
+    }
+    _BENCH_CLOCK.overhead_ticks = overhead;
+    _BENCH_CLOCK.calibrated = true;
+    atomic_store_explicit(&bench_clock_ready, true, memory_order_release);
+}
+
+#ifdef _WIN32
+static INIT_ONCE bench_clock_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK bench_clock_once_callback(PINIT_ONCE once, PVOID parameter, PVOID *context) {
+    (void)once;
+    (void)parameter;
+    (void)context;
+    bench_clock_measure();
+    return TRUE;
+}
 #else
-    struct timespec ts;
-    if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1) {
-        // Handle error
-        perror("Error: clock_gettime failed");
-        exit(EXIT_FAILURE);
+static pthread_once_t bench_clock_once = PTHREAD_ONCE_INIT;
+#endif
+
+// Measures once, threads that get here meanwhile wait for the result
+void fossil_bench_clock_calibrate(void) {
+    if (atomic_load_explicit(&bench_clock_ready, memory_order_acquire)) {
+        return;
     }
-    return (uint64_t)((ts.tv_sec * 1e9 + ts.tv_nsec) - start_time);
+#ifdef _WIN32
+    InitOnceExecuteOnce(&bench_clock_once, bench_clock_once_callback, xnull, xnull);
+#else
+    pthread_once(&bench_clock_once, bench_clock_measure);
 #endif
 }
 
-void assume_duration(double expected, double actual, double unit) {
-    clock_t end_time = clock();
-    double elapsed_time = (double)(end_time - start_time) / ((double)CLOCKS_PER_SEC / unit);
-    if (elapsed_time < expected) {
-        fossil_test_cout("red", "Benchmark failed: expected %f, got %f\n", expected, actual);
+uint64_t fossil_bench_ticks_to_ns(uint64_t ticks) {
+    return (uint64_t)((double)ticks * _BENCH_CLOCK.ns_per_tick + 0.5);
+}
+
+// ==============================================================================
+// Xmark timer objects
+// ==============================================================================
+
+// Ticks of one stretch between a start or resume and now, minus the clock overhead
+static uint64_t timer_stretch(const fossil_bench_timer_t *timer, uint64_t now) {
+    uint64_t ticks = now - timer->started;
+    return ticks > _BENCH_CLOCK.overhead_ticks ? ticks - _BENCH_CLOCK.overhead_ticks : 0;
+}
+
+void fossil_bench_timer_start(fossil_bench_timer_t *timer) {
+    fossil_bench_clock_calibrate();
+    timer->elapsed = 0;
+    timer->lap = 0;
+    timer->running = true;
+    timer->started = fossil_bench_ticks_start();
+}
+
+uint64_t fossil_bench_timer_elapsed(const fossil_bench_timer_t *timer) {
+    if (!timer->running) {
+        return fossil_bench_ticks_to_ns(timer->elapsed);
+    }
+    uint64_t now = fossil_bench_ticks_stop();
+    return fossil_bench_ticks_to_ns(timer->elapsed + timer_stretch(timer, now));
+}
+
+uint64_t fossil_bench_timer_lap(fossil_bench_timer_t *timer) {
+    uint64_t elapsed = timer->elapsed;
+    if (timer->running) {
+        elapsed += timer_stretch(timer, fossil_bench_ticks_stop());
+    }
+    uint64_t lap = elapsed - timer->lap;
+    timer->lap = elapsed;
+    return fossil_bench_ticks_to_ns(lap);
+}
+
+void fossil_bench_timer_pause(fossil_bench_timer_t *timer) {
+    if (timer->running) {
+        uint64_t now = fossil_bench_ticks_stop();
+        timer->elapsed += timer_stretch(timer, now);
+        timer->started = now; // kept so a resume knows how long the pause took
+        timer->running = false;
+    }
+}
+
+void fossil_bench_timer_resume(fossil_bench_timer_t *timer) {
+    if (!timer->running) {
+        timer->running = true;
+        timer->started = fossil_bench_ticks_start();
+    }
+}
+
+uint64_t fossil_bench_timer_stop(fossil_bench_timer_t *timer) {
+    fossil_bench_timer_pause(timer);
+    return fossil_bench_ticks_to_ns(timer->elapsed);
+}
+
+void fossil_test_start_benchmark(void) {
+    fossil_bench_timer_start(&thread_timer);
+}
+
+uint64_t fossil_test_elapsed_benchmark(void) {
+    return fossil_bench_timer_elapsed(&thread_timer);
+}
+
+uint64_t fossil_test_stop_benchmark(void) {
+    return fossil_bench_timer_stop(&thread_timer);
+}
+
+// ==============================================================================
+// Xmark statistical benchmark harness
+// ==============================================================================
+
+enum {
+    BENCH_GROWTH_MAX = 10,               // calibration grows iterations at most tenfold per step
+    BENCH_MAX_ITERATIONS = 1000000000    // guard for bodies the compiler turned into nothing
+};
+
+// Adds the counters of the sample that just ended to the totals
+static void bench_count(fossil_bench_t *bench) {
+    fossil_bench_counters_t end;
+    if (fossil_bench_counters_read(&end)) {
+        fossil_bench_counters_accumulate(&bench->counters, &bench->counters_begin, &end);
+        bench->counted_iterations += bench->iterations;
+    }
+}
+
+// Adds the allocations of the sample that just ended to the totals
+static void bench_count_allocs(fossil_bench_t *bench, fossil_test_allocs_t *scope) {
+    fossil_test_allocs_end(scope);
+    if (scope->valid) {
+        fossil_test_allocs_accumulate(&bench->allocs, scope);
+        bench->alloc_iterations += bench->iterations;
+    }
+}
+
+fossil_bench_histogram_t *fossil_bench_latency_create(const fossil_bench_t *bench) {
+    if (!bench->latency_wanted) {
+        return xnullptr;
+    }
+    fossil_bench_histogram_t *histogram = (fossil_bench_histogram_t*)fossil_test_arena_alloc(&_TEST_ENV.arena, sizeof(*histogram));
+    if (histogram != xnullptr) {
+        fossil_bench_histogram_reset(histogram);
+    }
+    return histogram;
+}
+
+void fossil_bench_pause(fossil_bench_t *bench) {
+    fossil_bench_timer_pause(&bench->timer);
+}
+
+void fossil_bench_resume(fossil_bench_t *bench) {
+    if (bench->timer.running) {
+        return;
+    }
+    uint64_t paused = bench->timer.started;
+    fossil_bench_timer_resume(&bench->timer);
+    bench->latency_last += bench->timer.started - paused;
+}
+
+void fossil_bench_iteration_setup(fossil_bench_t *bench) {
+    fossil_bench_pause(bench);
+    bench->iteration_setup(bench);
+    fossil_bench_resume(bench);
+}
+
+bool fossil_bench_sample_edge(fossil_bench_t *bench) {
+    if (!bench->running) {
+        if (bench->iteration_setup != xnullptr) {
+            bench->iteration_setup(bench); // the first iteration is set up before the clock starts
+        }
+        bench->running = true;
+        bench->looped = true;
+        bench->remaining = bench->iterations - 1;
+        if (bench->counting) {
+            fossil_bench_counters_read(&bench->counters_begin);
+        }
+        if (bench->alloc_counting) {
+            fossil_test_allocs_begin(&bench->allocs_scope);
+        }
+        fossil_bench_timer_start(&bench->timer);
+        bench->latency_last = bench->timer.started;
+        return true;
+    }
+    bench->elapsed_ns = fossil_bench_timer_stop(&bench->timer);
+    bench->running = false;
+    if (bench->alloc_counting) {
+        bench_count_allocs(bench, &bench->allocs_scope);
+    }
+    if (bench->counting) {
+        bench_count(bench);
+    }
+    return false;
+}
+
+// Publishes the pointer through a volatile store the optimizer cannot see past
+static const volatile void *volatile bench_sink = xnull;
+
+void fossil_bench_use_pointer(const volatile void *ptr) {
+    bench_sink = ptr;
+}
+
+// Runs one sample and returns its duration. Bodies that do not use
+// FOSSIL_BENCH_LOOP are called once per iteration and timed from here,
+// fossil_bench_sample takes the trace span around it.
+static uint64_t bench_sample(fossil_bench_t *bench) {
+    if (bench->looped) {
+        bench->running = false;
+        bench->function(bench);
+        return bench->elapsed_ns;
+    }
+
+    if (bench->counting) {
+        fossil_bench_counters_read(&bench->counters_begin);
+    }
+    fossil_test_allocs_t allocs;
+    if (bench->alloc_counting) {
+        fossil_test_allocs_begin(&allocs);
+    }
+    // the body may pause the timer of the benchmark, plain bodies are timed with it too
+    if (bench->iteration_setup != xnullptr) {
+        bench->iteration_setup(bench);
+    }
+    fossil_bench_timer_start(&bench->timer);
+    for (uint64_t iter = 0; iter < bench->iterations; iter++) {
+        if (iter > 0 && bench->iteration_setup != xnullptr) {
+            fossil_bench_iteration_setup(bench);
+        }
+        bench->function(bench);
+        fossil_bench_clobber_memory();
+        if (bench->looped) {
+            if (bench->alloc_counting) {
+                fossil_test_allocs_end(&allocs); // the loop counted its own
+            }
+            return bench->elapsed_ns; // discovered on the first call
+        }
+    }
+    uint64_t elapsed = fossil_bench_timer_stop(&bench->timer);
+    if (bench->alloc_counting) {
+        bench_count_allocs(bench, &allocs);
+    }
+    if (bench->counting) {
+        bench_count(bench);
+    }
+    return elapsed;
+}
+
+uint64_t fossil_bench_sample(fossil_bench_t *bench) {
+    uint64_t traced = fossil_test_trace_begin();
+    uint64_t elapsed = bench_sample(bench);
+    fossil_test_trace_end("bench", bench->name, bench->thread_index, traced);
+    return elapsed;
+}
+
+// Grows the iteration count until one sample takes the target time.
+void fossil_bench_calibrate(fossil_bench_t *bench, uint64_t target_ns) {
+    bench->iterations = 1;
+    for (;;) {
+        // Paused time is not in the sample, also going by the wall clock keeps
+        // a body with a slow untimed setup from growing samples past the target
+        uint64_t started = fossil_test_clock_ns();
+        uint64_t ns = fossil_bench_sample(bench);
+        uint64_t wall = fossil_test_clock_ns() - started;
+        if (wall > ns) {
+            ns = wall;
+        }
+        if (ns >= target_ns || bench->iterations >= BENCH_MAX_ITERATIONS) {
+            if (ns > 0) {
+                double scaled = (double)bench->iterations * (double)target_ns / (double)ns;
+                bench->iterations = scaled >= 1.0 ? (uint64_t)scaled : 1;
+            }
+            return;
+        }
+
+        double growth = ns > 0 ? 1.2 * (double)target_ns / (double)ns : (double)BENCH_GROWTH_MAX;
+        if (growth > BENCH_GROWTH_MAX) {
+            growth = BENCH_GROWTH_MAX;
+        } else if (growth < 2.0) {
+            growth = 2.0;
+        }
+        bench->iterations = (uint64_t)((double)bench->iterations * growth);
+    }
+}
+
+static int bench_compare(const void *lhs, const void *rhs) {
+    double a = *(const double*)lhs;
+    double b = *(const double*)rhs;
+    return (a > b) - (a < b);
+}
+
+static double bench_median(const double *sorted, int32_t count) {
+    if (count % 2 == 1) {
+        return sorted[count / 2];
+    }
+    return (sorted[count / 2 - 1] + sorted[count / 2]) / 2.0;
+}
+
+static double bench_mad(const double *sorted, int32_t count, double median) {
+    double deviation[FOSSIL_BENCH_MAX_SAMPLES];
+    for (int32_t i = 0; i < count; i++) {
+        deviation[i] = fabs(sorted[i] - median);
+    }
+    qsort(deviation, (size_t)count, sizeof(double), bench_compare);
+    return bench_median(deviation, count);
+}
+
+void fossil_bench_stats(const double *samples, int32_t count, fossil_bench_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (samples == xnullptr || count <= 0) {
+        return;
+    }
+    if (count > FOSSIL_BENCH_MAX_SAMPLES) {
+        count = FOSSIL_BENCH_MAX_SAMPLES;
+    }
+
+    double sorted[FOSSIL_BENCH_MAX_SAMPLES];
+    memcpy(sorted, samples, (size_t)count * sizeof(double));
+    qsort(sorted, (size_t)count, sizeof(double), bench_compare);
+
+    // reject samples with a modified z-score above 3.5 (Iglewicz and Hoaglin)
+    double median = bench_median(sorted, count);
+    double mad = bench_mad(sorted, count, median);
+    int32_t kept = 0;
+    for (int32_t i = 0; i < count; i++) {
+        if (mad == 0.0 || 0.6745 * fabs(sorted[i] - median) / mad <= 3.5) {
+            sorted[kept++] = sorted[i];
+        }
+    }
+
+    double sum = 0.0;
+    for (int32_t i = 0; i < kept; i++) {
+        sum += sorted[i];
+    }
+
+    int32_t rank = (int32_t)ceil(0.99 * (double)kept);
+    stats->samples = kept;
+    stats->outliers = count - kept;
+    stats->min_ns = sorted[0];
+    stats->max_ns = sorted[kept - 1];
+    stats->mean_ns = sum / (double)kept;
+    stats->median_ns = bench_median(sorted, kept);
+    stats->mad_ns = bench_mad(sorted, kept, stats->median_ns);
+    stats->p99_ns = sorted[(rank < 1 ? 1 : rank) - 1];
+}
+
+// Adds the benchmark to the results of this run, once
+static void bench_record(fossil_bench_t *bench) {
+    fossil_bench_t **link = &_TEST_ENV.benches;
+    while (*link != xnullptr) {
+        if (*link == bench) {
+            return;
+        }
+        link = &(*link)->next;
+    }
+    bench->next = xnullptr;
+    *link = bench;
+}
+
+// Turns the samples into rates of what one iteration processes
+static void bench_rate(const fossil_bench_t *bench, fossil_bench_rate_t *rate) {
+    double rates[FOSSIL_BENCH_MAX_SAMPLES];
+    int32_t count = 0;
+    if (rate->per_iteration == 0) {
+        return;
+    }
+    for (int32_t i = 0; i < bench->sample_count; i++) {
+        if (bench->samples[i] > 0.0) {
+            rates[count++] = (double)rate->per_iteration * 1e9 / bench->samples[i];
+        }
+    }
+    fossil_bench_stats_t stats;
+    fossil_bench_stats(rates, count, &stats);
+    rate->median = stats.median_ns;
+    rate->mad = stats.mad_ns;
+    rate->min = stats.min_ns;
+}
+
+// Fails the benchmark when it allocated more per iteration than its body allows
+static void bench_expect_allocs(fossil_bench_t *bench) {
+    static char message[256];
+    if (bench->alloc_limit < 0.0 || bench->alloc_iterations == 0) {
+        return;
+    }
+    double per_iteration = (double)bench->allocs.allocs / (double)bench->alloc_iterations;
+    if (per_iteration > bench->alloc_limit) {
+        snprintf(message, sizeof(message), "benchmark %s made %.2f allocations per iteration, expected at most %.2f",
+            bench->name, per_iteration, bench->alloc_limit);
+        _fossil_test_assert_class(false, TEST_ASSERT_AS_CLASS_EXPECT, message, (char*)__FILE__, __LINE__, (char*)__func__);
+    }
+}
+
+// Clears what an earlier run of the same benchmark left behind
+static void bench_reset(fossil_bench_t *bench, const char *name, fossil_bench_function_t function) {
+    bench->name = name;
+    bench->function = function;
+    bench->iteration_setup = xnullptr;
+    bench->thread_index = 0;
+    bench->thread_count = 1;
+    bench->running = false;
+    bench->looped = false;
+    bench->counting = false;
+    bench->sample_count = 0;
+    bench->counted_iterations = 0;
+    memset(&bench->counters, 0, sizeof(bench->counters));
+    bench->alloc_counting = false;
+    bench->alloc_limit = -1.0;
+    bench->alloc_iterations = 0;
+    memset(&bench->allocs, 0, sizeof(bench->allocs));
+    memset(&bench->processed_bytes, 0, sizeof(bench->processed_bytes));
+    memset(&bench->processed_items, 0, sizeof(bench->processed_items));
+    bench->latency_wanted = false;
+    bench->latency_laps = false;
+    bench->latency = xnullptr;
+    bench->cold_wanted = false;
+    bench->cold_branches = false;
+    bench->cold_data = xnullptr;
+    bench->cold_size = 0;
+    bench->cold_count = 0;
+    memset(&bench->cold_stats, 0, sizeof(bench->cold_stats));
+}
+
+// Samples kept per benchmark, in bench mode every repeat is one sample
+static int32_t bench_sample_target(void) {
+    if (!_CLI.bench_mode || !_CLI.repeat_enabled || _CLI.repeat_count < 1) {
+        return FOSSIL_BENCH_SAMPLES;
+    }
+    return _CLI.repeat_count < FOSSIL_BENCH_MAX_SAMPLES ? _CLI.repeat_count : FOSSIL_BENCH_MAX_SAMPLES;
+}
+
+// Calibrates the iterations of one sample and warms up
+static void bench_warm(fossil_bench_t *bench) {
+    uint64_t started = fossil_test_clock_ns();
+    fossil_bench_calibrate(bench, FOSSIL_BENCH_SAMPLE_NS);
+    while (fossil_test_clock_ns() - started < FOSSIL_BENCH_WARMUP_NS) {
+        fossil_bench_sample(bench);
+    }
+}
+
+// Counters and allocations are only read around the samples that are kept
+static void bench_keep_begin(fossil_bench_t *bench) {
+    bench->latency = fossil_bench_latency_create(bench);
+    bench->counting = _CLI.counters_enabled && fossil_bench_counters_open();
+    bench->alloc_counting = fossil_test_allocs_available();
+}
+
+static void bench_keep_sample(fossil_bench_t *bench) {
+    uint64_t ns = fossil_bench_sample(bench);
+    bench->samples[bench->sample_count++] = (double)ns / (double)bench->iterations;
+}
+
+// Takes the cold samples, one iteration each after evicting the caches.
+// Counters, allocations and latencies only cover the warm samples.
+static void bench_cold(fossil_bench_t *bench) {
+    if (!bench->cold_wanted && !_CLI.bench_cold) {
+        return;
+    }
+    fossil_bench_histogram_t *latency = bench->latency;
+    uint64_t iterations = bench->iterations;
+    bench->latency = xnullptr;
+    bench->iterations = 1;
+    int32_t target = bench_sample_target();
+    for (int32_t i = 0; i < target; i++) {
+        if (bench->cold_data != xnullptr) {
+            fossil_bench_flush_range(bench->cold_data, bench->cold_size);
+        } else {
+            fossil_bench_evict_caches();
+        }
+        if (bench->cold_branches || _CLI.bench_cold_branches) {
+            fossil_bench_disturb_branches();
+        }
+        bench->cold_samples[bench->cold_count++] = (double)fossil_bench_sample(bench);
+    }
+    fossil_bench_evict_release();
+    bench->iterations = iterations;
+    bench->latency = latency;
+    fossil_bench_stats(bench->cold_samples, bench->cold_count, &bench->cold_stats);
+}
+
+// Summarises the kept samples and reports them
+static void bench_finish(fossil_bench_t *bench) {
+    bench->counting = false;
+    bench->alloc_counting = false;
+    bench_cold(bench);
+
+    fossil_bench_stats(bench->samples, bench->sample_count, &bench->stats);
+    bench_rate(bench, &bench->processed_bytes);
+    bench_rate(bench, &bench->processed_items);
+    bench_record(bench);
+    fossil_bench_gate(bench);
+    bench_expect_allocs(bench);
+    fossil_test_io_bench_result(bench);
+}
+
+void fossil_bench_run(fossil_bench_t *bench, const char *name, fossil_bench_function_t function) {
+    if (bench == xnullptr || function == xnullptr) {
+        return;
+    }
+    bench_reset(bench, name, function);
+    bench_warm(bench);
+    bench_keep_begin(bench);
+    int32_t target = bench_sample_target();
+    for (int32_t i = 0; i < target; i++) {
+        bench_keep_sample(bench);
+    }
+    bench_finish(bench);
+}
+
+// Body of the test case sampled by fossil_bench_run_case, cases run one at a time
+static void (*bench_case_function)(void) = xnullptr;
+
+static void bench_case_body(fossil_bench_t *bench) {
+    (void)bench;
+    bench_case_function();
+}
+
+void fossil_bench_run_case(fossil_bench_t *bench, const char *name, void (*function)(void)) {
+    if (bench == xnullptr || function == xnullptr) {
+        return;
+    }
+    bench_reset(bench, name, bench_case_body);
+    bench_case_function = function;
+    bench->iterations = 1;
+    fossil_bench_sample(bench); // one call that is not kept warms the caches
+    bench_keep_begin(bench);
+    int32_t target = bench_sample_target();
+    for (int32_t i = 0; i < target; i++) {
+        bench_keep_sample(bench);
+    }
+    bench_finish(bench);
+    bench_case_function = xnullptr;
+}
+
+// Adds the range benchmark to the results of this run, once
+static void bench_record_range(fossil_bench_range_t *range) {
+    fossil_bench_range_t **link = &_TEST_ENV.ranges;
+    while (*link != xnullptr) {
+        if (*link == range) {
+            return;
+        }
+        link = &(*link)->next;
+    }
+    range->next = xnullptr;
+    *link = range;
+}
+
+// Value of the complexity class at input size n
+static double bench_complexity_at(fossil_bench_complexity_t complexity, double n) {
+    switch (complexity) {
+        case FOSSIL_BENCH_O_LOG_N:     return log2(n);
+        case FOSSIL_BENCH_O_N:         return n;
+        case FOSSIL_BENCH_O_N_LOG_N:   return n * log2(n);
+        case FOSSIL_BENCH_O_N_SQUARED: return n * n;
+        default:                       return 1.0;
+    }
+}
+
+const char *fossil_bench_complexity_name(fossil_bench_complexity_t complexity) {
+    switch (complexity) {
+        case FOSSIL_BENCH_O_LOG_N:     return "O(log n)";
+        case FOSSIL_BENCH_O_N:         return "O(n)";
+        case FOSSIL_BENCH_O_N_LOG_N:   return "O(n log n)";
+        case FOSSIL_BENCH_O_N_SQUARED: return "O(n^2)";
+        default:                       return "O(1)";
+    }
+}
+
+void fossil_bench_fit(const double *sizes, const double *times, int32_t count, fossil_bench_fit_t *fit) {
+    memset(fit, 0, sizeof(*fit));
+    if (count < 2) {
+        return;
+    }
+    double mean = 0.0;
+    for (int32_t i = 0; i < count; i++) {
+        mean += times[i];
+    }
+    mean /= (double)count;
+    if (mean <= 0.0) {
+        return;
+    }
+
+    // time = c * f(n) without intercept, c minimises the squared error
+    for (int32_t c = 0; c < FOSSIL_BENCH_O_COUNT; c++) {
+        double ff = 0.0;
+        double tf = 0.0;
+        for (int32_t i = 0; i < count; i++) {
+            double f = bench_complexity_at((fossil_bench_complexity_t)c, sizes[i]);
+            ff += f * f;
+            tf += times[i] * f;
+        }
+        if (ff <= 0.0) {
+            continue;
+        }
+        double coefficient = tf / ff;
+        double error = 0.0;
+        for (int32_t i = 0; i < count; i++) {
+            double residual = times[i] - coefficient * bench_complexity_at((fossil_bench_complexity_t)c, sizes[i]);
+            error += residual * residual;
+        }
+        double rms = sqrt(error / (double)count) / mean;
+        if (!fit->valid || rms < fit->rms) {
+            fit->valid = true;
+            fit->complexity = (fossil_bench_complexity_t)c;
+            fit->coefficient_ns = coefficient;
+            fit->rms = rms;
+        }
+    }
+}
+
+void fossil_bench_run_range(fossil_bench_range_t *range, const char *name, fossil_bench_function_t function,
+    int64_t low, int64_t high, int64_t multiplier) {
+    if (range == xnullptr || function == xnullptr || low < 1 || multiplier < 2) {
+        return;
+    }
+    range->low = low;
+    range->high = high;
+    range->multiplier = multiplier;
+    range->bench.name = name;
+    range->bench.function = function;
+
+    double sizes[FOSSIL_BENCH_MAX_POINTS];
+    double times[FOSSIL_BENCH_MAX_POINTS];
+    int32_t count = 0;
+    for (int64_t arg = range->low; arg <= range->high && count < FOSSIL_BENCH_MAX_POINTS; arg *= range->multiplier) {
+        // points are kept from an earlier run of the same range
+        fossil_bench_t *point = count < range->point_count ? range->points[count] : xnullptr;
+        if (point == xnullptr) {
+            char label[FOSSIL_BENCH_NAME_MAX];
+            snprintf(label, sizeof(label), "%s/%lld", name, (long long)arg);
+            point = (fossil_bench_t*)fossil_test_arena_alloc(&_TEST_ENV.arena, sizeof(*point));
+            if (point == xnullptr) {
+                break;
+            }
+            memset(point, 0, sizeof(*point));
+            point->name = fossil_test_arena_strdup(&_TEST_ENV.arena, label);
+            range->points[count] = point;
+        }
+        point->arg = arg;
+        fossil_bench_run(point, point->name, function);
+        sizes[count] = (double)arg;
+        times[count] = point->stats.median_ns;
+        count++;
+        if (arg > INT64_MAX / range->multiplier) {
+            break;
+        }
+    }
+    range->point_count = count;
+
+    fossil_bench_fit(sizes, times, count, &range->fit);
+    bench_record_range(range);
+    fossil_test_io_bench_fit(range);
+}
+
+// Adds the A/B benchmark to the results of this run, once
+static void bench_record_ab(fossil_bench_ab_t *ab) {
+    fossil_bench_ab_t **link = &_TEST_ENV.ab_benches;
+    while (*link != xnullptr) {
+        if (*link == ab) {
+            return;
+        }
+        link = &(*link)->next;
+    }
+    ab->next = xnullptr;
+    *link = ab;
+}
+
+void fossil_bench_run_ab(fossil_bench_ab_t *ab, const char *name, fossil_bench_function_t function,
+    const char *const *variants, int32_t count) {
+    if (ab == xnullptr || function == xnullptr || variants == xnullptr || count < 1) {
+        return;
+    }
+    ab->bench.name = name;
+    ab->bench.function = function;
+    ab->variants = variants;
+    if (count > FOSSIL_BENCH_AB_VARIANTS) {
+        fossil_test_cout("yellow", "%s has %d variants, only the first %d are sampled\n", name, count, FOSSIL_BENCH_AB_VARIANTS);
+        count = FOSSIL_BENCH_AB_VARIANTS;
+    }
+
+    int32_t used = 0;
+    for (int32_t i = 0; i < count; i++) {
+        // variants are kept from an earlier run of the same benchmark
+        fossil_bench_t *point = i < ab->variant_count ? ab->points[i] : xnullptr;
+        if (point == xnullptr) {
+            char label[FOSSIL_BENCH_NAME_MAX];
+            snprintf(label, sizeof(label), "%s/%s", name, variants[i]);
+            point = (fossil_bench_t*)fossil_test_arena_alloc(&_TEST_ENV.arena, sizeof(*point));
+            if (point == xnullptr) {
+                break;
+            }
+            memset(point, 0, sizeof(*point));
+            point->name = fossil_test_arena_strdup(&_TEST_ENV.arena, label);
+        }
+        ab->points[i] = point;
+        bench_reset(point, point->name, function);
+        point->variant = i;
+        point->variant_name = variants[i];
+        bench_warm(point);
+        used++;
+    }
+    ab->variant_count = used;
+    for (int32_t i = 0; i < used; i++) {
+        bench_keep_begin(ab->points[i]);
+    }
+
+    // every round samples each variant once, in an order shuffled from a fixed seed
+    int32_t order[FOSSIL_BENCH_AB_VARIANTS];
+    uint64_t state = 0x2545f4914f6cdd1dULL;
+    int32_t rounds = bench_sample_target();
+    for (int32_t round = 0; round < rounds; round++) {
+        for (int32_t i = 0; i < used; i++) {
+            order[i] = i;
+        }
+        for (int32_t i = used - 1; i > 0; i--) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            int32_t j = (int32_t)(state % (uint64_t)(i + 1));
+            int32_t swap = order[i];
+            order[i] = order[j];
+            order[j] = swap;
+        }
+        for (int32_t i = 0; i < used; i++) {
+            bench_keep_sample(ab->points[order[i]]);
+        }
+    }
+
+    for (int32_t i = 0; i < used; i++) {
+        bench_finish(ab->points[i]);
+    }
+    for (int32_t i = 0; i < used; i++) {
+        fossil_bench_compare(ab->points[0]->samples, ab->points[0]->sample_count, ab->points[i]->samples,
+            ab->points[i]->sample_count, _CLI.bench_threshold / 100.0, &ab->versus[i]);
+    }
+    bench_record_ab(ab);
+    fossil_test_io_bench_ab(ab);
+}
+
+// Reports when the elapsed time goes over the limit given in the unit
+static void assume_duration(double elapsed_ns, double limit, double unit) {
+    double elapsed = elapsed_ns * 1e-9 / unit;
+    if (elapsed > limit) {
+        fossil_test_cout("red", "Benchmark failed: expected at most %f, got %f\n", limit, elapsed);
     }
 }
 
-// Marks a test case as timeout with a specified time and prints it to stderr.
-void fossil_test_benchmark(char* duration_type, double expected, double actual) {
+// Reports a benchmark that took longer than the limit given in the unit.
+void fossil_test_benchmark(char* duration_type, double elapsed, double limit) {
     if (strcmp(duration_type, "minutes") == 0) {
-        assume_duration(expected, actual, 60.0);
+        assume_duration(elapsed, limit, 60.0);
     } else if (strcmp(duration_type, "seconds") == 0) {
-        assume_duration(expected, actual, 1.0);
+        assume_duration(elapsed, limit, 1.0);
     } else if (strcmp(duration_type, "milliseconds") == 0) {
-        assume_duration(expected, actual, 0.001);
+        assume_duration(elapsed, limit, 0.001);
     } else if (strcmp(duration_type, "microseconds") == 0) {
-        assume_duration(expected, actual, 1e-6);
+        assume_duration(elapsed, limit, 1e-6);
     } else if (strcmp(duration_type, "nanoseconds") == 0) {
-        assume_duration(expected, actual, 1e-9);
+        assume_duration(elapsed, limit, 1e-9);
     } else if (strcmp(duration_type, "picoseconds") == 0) {
-        assume_duration(expected, actual, 1e-12);
+        assume_duration(elapsed, limit, 1e-12);
     } else if (strcmp(duration_type, "femtoseconds") == 0) {
-        assume_duration(expected, actual, 1e-15);
+        assume_duration(elapsed, limit, 1e-15);
     } else if (strcmp(duration_type, "attoseconds") == 0) {
-        assume_duration(expected, actual, 1e-18);
+        assume_duration(elapsed, limit, 1e-18);
     } else if (strcmp(duration_type, "zeptoseconds") == 0) {
-        assume_duration(expected, actual, 1e-21);
+        assume_duration(elapsed, limit, 1e-21);
     } else if (strcmp(duration_type, "yoctoseconds") == 0) {
-        assume_duration(expected, actual, 1e-24);
+        assume_duration(elapsed, limit, 1e-24);
     } else {
         fossil_test_cout("red", "Unknown option: %s\n", duration_type);
     }
@@ -0,0 +1,148 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/unittest/cold.h"
+#include "fossil/unittest/benchmark.h"
+#include "fossil/_common/platform.h"
+
+// ==============================================================================
+// Xmark functions for cold cache benchmarks
+// ==============================================================================
+
+enum {
+    EVICT_FALLBACK_BYTES = 64 * 1024 * 1024, // when the cache sizes are unknown
+    DISTURB_ROUNDS       = 1 << 16           // random branches run per disturbance
+};
+
+static char *evict_buffer = xnullptr;
+static size_t evict_size = 0;
+static size_t evict_line = 0;
+
+size_t fossil_bench_evict_bytes(void) {
+    size_t total = 0;
+    for (int level = 1; level <= 3; level++) {
+        total += _fossil_test_get_cache_size(level);
+    }
+    if (total == 0) {
+        return EVICT_FALLBACK_BYTES;
+    }
+    // half again the caches together, so a cache that does not keep its
+    // own copy of the levels below is swept as well
+    size_t bytes = total + total / 2;
+    size_t memory = (size_t)_fossil_test_get_memory_size() * 1024 * 1024;
+    if (memory > 0 && bytes > memory / 4) {
+        bytes = memory / 4;
+    }
+    return bytes;
+}
+
+void fossil_bench_evict_caches(void) {
+    if (evict_buffer == xnullptr) {
+        evict_size = fossil_bench_evict_bytes();
+        evict_line = _fossil_test_get_cache_line_size();
+        evict_buffer = (char*)malloc(evict_size);
+        if (evict_buffer == xnullptr) {
+            return;
+        }
+        // written once, untouched pages would all read the same zero page
+        memset(evict_buffer, 1, evict_size);
+    }
+    uint64_t sum = 0;
+    for (size_t at = 0; at < evict_size; at += evict_line) {
+        sum += (uint64_t)(unsigned char)evict_buffer[at];
+    }
+    fossil_bench_do_not_optimize(&sum);
+}
+
+void fossil_bench_evict_release(void) {
+    free(evict_buffer);
+    evict_buffer = xnullptr;
+    evict_size = 0;
+}
+
+void fossil_bench_flush_range(const void *data, size_t size) {
+    if (data == xnullptr || size == 0) {
+        return;
+    }
+    size_t line = _fossil_test_get_cache_line_size();
+    const char *at = (const char*)((uintptr_t)data - (uintptr_t)data % line);
+    const char *end = (const char*)data + size;
+#if defined(FOSSIL_BENCH_CYCLES_X86) && defined(_MSC_VER)
+    for (; at < end; at += line) {
+        _mm_clflush(at);
+    }
+    _mm_mfence();
+#elif defined(FOSSIL_BENCH_CYCLES_X86)
+    for (; at < end; at += line) {
+        __asm__ __volatile__("clflush %0" : : "m"(*(const volatile char*)at) : "memory");
+    }
+    __asm__ __volatile__("mfence" : : : "memory");
+#elif defined(FOSSIL_BENCH_CYCLES_ARM64)
+    for (; at < end; at += line) {
+        __asm__ __volatile__("dc civac, %0" : : "r"(at) : "memory");
+    }
+    __asm__ __volatile__("dsb ish" : : : "memory");
+#else
+    (void)at;
+    (void)end;
+    fossil_bench_evict_caches();
+#endif
+}
+
+// Targets of the indirect calls, picked at random every round
+static uint64_t disturb_add(uint64_t value) {
+    return value + 0x9e3779b97f4a7c15ULL;
+}
+
+static uint64_t disturb_xor(uint64_t value) {
+    return value ^ (value >> 29);
+}
+
+static uint64_t disturb_rotate(uint64_t value) {
+    return value << 7 | value >> 57;
+}
+
+static uint64_t disturb_multiply(uint64_t value) {
+    return value * 0x2545f4914f6cdd1dULL;
+}
+
+static uint64_t (*const disturb_targets[])(uint64_t) = {
+    disturb_add, disturb_xor, disturb_rotate, disturb_multiply
+};
+
+void fossil_bench_disturb_branches(void) {
+    // carried over between calls so every disturbance takes other paths
+    static uint64_t state = 0x9e3779b97f4a7c15ULL;
+    uint64_t value = 0;
+    for (int32_t round = 0; round < DISTURB_ROUNDS; round++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        if (state & 1) {
+            value += state;
+        } else {
+            value ^= state >> 3;
+        }
+        switch ((state >> 8) & 7) {
+            case 0:  value += 3; break;
+            case 1:  value ^= 0x55; break;
+            case 2:  value -= state >> 40; break;
+            case 3:  value = value << 1 | value >> 63; break;
+            case 4:  value *= 5; break;
+            case 5:  value ^= state; break;
+            case 6:  value += state >> 20; break;
+            default: value = ~value; break;
+        }
+        value = disturb_targets[(state >> 16) & 3](value);
+    }
+    fossil_bench_do_not_optimize(&value);
+}
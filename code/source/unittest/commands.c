@@ -30,6 +30,7 @@ fossil_options_t init_options(void) {
     options.reverse = false;
     options.repeat_enabled = false;
     options.repeat_count = 1;
+    options.bench_mode = false;
     options.shuffle_enabled = false;
     options.verbose_enabled = false;
     options.verbose_level = 1;
@@ -37,6 +38,26 @@ fossil_options_t init_options(void) {
     options.summary_enabled = false;
     options.color_enabled = false;
     options.sanity_enabled = false;
+    options.progress_enabled = true;
+    options.slowest_enabled = false;
+    options.slowest_count = 10;
+    options.capture_enabled = true;
+    options.counters_enabled = false;
+    options.allocs_enabled = false;
+    options.bench_save_file[0] = '\0';
+    options.bench_compare_file[0] = '\0';
+    options.bench_histogram_file[0] = '\0';
+    options.bench_threshold = 5.0;
+    options.bench_threads = 0;
+    options.bench_cpu = -1;
+    options.bench_priority = false;
+    options.bench_cold = false;
+    options.bench_cold_branches = false;
+    options.compare_enabled = false;
+    options.compare_old_file[0] = '\0';
+    options.compare_new_file[0] = '\0';
+    options.compare_json = false;
+    options.trace_file[0] = '\0';
     return options;
 }
 
@@ -73,6 +94,8 @@ fossil_options_t fossil_options_parse(int argc, char **argv) {
                 options.repeat_count = atoi(argv[i + 1]);
                 i++;
             }
+        } else if (strcmp(argv[i], "bench") == 0) {
+            options.bench_mode = true;
         } else if (strcmp(argv[i], "shuffle") == 0) {
             if (i + 1 < argc && strcmp(argv[i + 1], "enable") == 0) {
                 options.shuffle_enabled = true;
@@ -106,6 +129,101 @@ fossil_options_t fossil_options_parse(int argc, char **argv) {
             } else if (i + 1 < argc && strcmp(argv[i + 1], "disable") == 0) {
                 options.sanity_enabled = false;
             }
+        } else if (strcmp(argv[i], "slowest") == 0) {
+            options.slowest_enabled = true;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) {
+                options.slowest_count = atoi(argv[i + 1]);
+                i++;
+            }
+        } else if (strcmp(argv[i], "progress") == 0) {
+            if (i + 1 < argc && strcmp(argv[i + 1], "enable") == 0) {
+                options.progress_enabled = true;
+            } else if (i + 1 < argc && strcmp(argv[i + 1], "disable") == 0) {
+                options.progress_enabled = false;
+            }
+        } else if (strcmp(argv[i], "bench-save") == 0) {
+            if (i + 1 < argc) {
+                snprintf(options.bench_save_file, sizeof(options.bench_save_file), "%s", argv[i + 1]);
+                i++;
+            }
+        } else if (strcmp(argv[i], "bench-compare") == 0) {
+            if (i + 1 < argc) {
+                snprintf(options.bench_compare_file, sizeof(options.bench_compare_file), "%s", argv[i + 1]);
+                i++;
+            }
+        } else if (strcmp(argv[i], "bench-histogram") == 0) {
+            if (i + 1 < argc) {
+                snprintf(options.bench_histogram_file, sizeof(options.bench_histogram_file), "%s", argv[i + 1]);
+                i++;
+            }
+        } else if (strcmp(argv[i], "trace") == 0) {
+            if (i + 1 < argc) {
+                snprintf(options.trace_file, sizeof(options.trace_file), "%s", argv[i + 1]);
+                i++;
+            }
+        } else if (strcmp(argv[i], "bench-threshold") == 0) {
+            if (i + 1 < argc && (isdigit((unsigned char)argv[i + 1][0]) || argv[i + 1][0] == '.')) {
+                options.bench_threshold = atof(argv[i + 1]);
+                i++;
+            }
+        } else if (strcmp(argv[i], "compare") == 0) {
+            options.compare_enabled = true;
+            if (i + 2 < argc) {
+                snprintf(options.compare_old_file, sizeof(options.compare_old_file), "%s", argv[i + 1]);
+                snprintf(options.compare_new_file, sizeof(options.compare_new_file), "%s", argv[i + 2]);
+                i += 2;
+            }
+            if (i + 1 < argc && strcmp(argv[i + 1], "json") == 0) {
+                options.compare_json = true;
+                i++;
+            } else if (i + 1 < argc && strcmp(argv[i + 1], "table") == 0) {
+                options.compare_json = false;
+                i++;
+            }
+        } else if (strcmp(argv[i], "bench-cpu") == 0) {
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) {
+                options.bench_cpu = atoi(argv[i + 1]);
+                i++;
+            }
+        } else if (strcmp(argv[i], "bench-priority") == 0) {
+            if (i + 1 < argc && strcmp(argv[i + 1], "enable") == 0) {
+                options.bench_priority = true;
+            } else if (i + 1 < argc && strcmp(argv[i + 1], "disable") == 0) {
+                options.bench_priority = false;
+            }
+        } else if (strcmp(argv[i], "bench-cold") == 0) {
+            if (i + 1 < argc && strcmp(argv[i + 1], "enable") == 0) {
+                options.bench_cold = true;
+            } else if (i + 1 < argc && strcmp(argv[i + 1], "branches") == 0) {
+                options.bench_cold = true;
+                options.bench_cold_branches = true;
+            } else if (i + 1 < argc && strcmp(argv[i + 1], "disable") == 0) {
+                options.bench_cold = false;
+                options.bench_cold_branches = false;
+            }
+        } else if (strcmp(argv[i], "bench-threads") == 0) {
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) {
+                options.bench_threads = atoi(argv[i + 1]);
+                i++;
+            }
+        } else if (strcmp(argv[i], "allocs") == 0) {
+            if (i + 1 < argc && strcmp(argv[i + 1], "enable") == 0) {
+                options.allocs_enabled = true;
+            } else if (i + 1 < argc && strcmp(argv[i + 1], "disable") == 0) {
+                options.allocs_enabled = false;
+            }
+        } else if (strcmp(argv[i], "counters") == 0) {
+            if (i + 1 < argc && strcmp(argv[i + 1], "enable") == 0) {
+                options.counters_enabled = true;
+            } else if (i + 1 < argc && strcmp(argv[i + 1], "disable") == 0) {
+                options.counters_enabled = false;
+            }
+        } else if (strcmp(argv[i], "capture") == 0) {
+            if (i + 1 < argc && strcmp(argv[i + 1], "enable") == 0) {
+                options.capture_enabled = true;
+            } else if (i + 1 < argc && strcmp(argv[i + 1], "disable") == 0) {
+                options.capture_enabled = false;
+            }
         }
     }
     
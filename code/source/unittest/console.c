@@ -13,7 +13,18 @@ Description:
 #include "fossil/unittest/console.h"
 #include "fossil/unittest/internal.h"
 #include "fossil/unittest/commands.h"
+#include "fossil/unittest/benchmark.h"
+#include "fossil/unittest/baseline.h"
+#include "fossil/unittest/scaling.h"
+#include "fossil/unittest/workingset.h"
+#include "fossil/unittest/trace.h"
 #include <stdarg.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
 
 static const char* FOSSIL_TEST_NAME = "Fossil Test";
 static const char* FOSSIL_TEST_AUTH = "Michael Gene Brockus (Dreamer)";
@@ -206,37 +217,26 @@ char* current_datetime(void) {
 
     strftime(datetime, sizeof(datetime), "%Y-%m-%d %H:%M:%S", timeinfo);
 
-    char* copy = _custom_fossil_test_strdup(datetime);  // Return a dynamically allocated copy of the datetime
-    if (!copy) {
-        return xnullptr; // Check for memory allocation failure
-    }
-
-    char* result = _custom_fossil_test_strdup(datetime);  // Return a dynamically allocated copy of the datetime
-    free(copy);  // Free the temporary copy
-
-    return result;
+    return datetime;
 }
 
-static char* replace_underscore(const char* str) {
-    if (!str) {
-        return xnullptr; // Check for xnull input
-    }
-
-    char* result = _custom_fossil_test_strdup(str);
-    if (!result) {
-        return xnullptr; // Check for memory allocation failure
-    }
+// Display names are computed once when a test is added to the environment
+static const char* display_name(const fossil_test_t* test) {
+    return test->display_name != xnullptr ? test->display_name : test->name;
+}
 
-    for (char* ptr = result; *ptr; ptr++) {
-        if (*ptr == '_') {
-            *ptr = ' ';
-        }
-    }
+// Framework output goes through this stream. While test output is captured
+// it points at a duplicate of the real stdout so reports are never buffered.
+static FILE *console = xnullptr;
 
-    char* copy = _custom_fossil_test_strdup(result);  // Create a copy to free the original
-    free(result);  // Free the original
+static FILE *console_stream(void) {
+    return console != xnullptr ? console : stdout;
+}
 
-    return copy;
+FILE *fossil_test_io_console(FILE *stream) {
+    FILE *previous = console;
+    console = stream;
+    return previous;
 }
 
 // Define color codes
@@ -289,12 +289,12 @@ void fossil_test_cout(const char* color_name, const char* format, ...) {
         }
 
         // Print color code and formatted string
-        printf("%s", color_code);
-        vprintf(format, args);
-        printf("%s", COLOR_RESET); // Reset color
+        fprintf(console_stream(), "%s", color_code);
+        vfprintf(console_stream(), format, args);
+        fprintf(console_stream(), "%s", COLOR_RESET); // Reset color
     } else {
         // Color output disabled, print formatted string directly
-        vprintf(format, args);
+        vfprintf(console_stream(), format, args);
     }
 
     va_end(args);
@@ -314,6 +314,323 @@ static void calculate_elapsed_time(fossil_test_timer_t *timer) {
     timer->detail.nanoseconds = (timer->elapsed * 1000000000) / CLOCKS_PER_SEC;
 }
 
+// ==============================================================================
+// Xtest live progress display
+// ==============================================================================
+
+enum {
+    PROGRESS_REDRAW_NS = 100000000, // redraw at most every 100 ms
+    PROGRESS_BAR_WIDTH = 30,
+    PROGRESS_NAME_WIDTH = 60
+};
+
+static struct {
+    bool active;              // dashboard drawn instead of cutback markers
+    bool drawn;               // the two dashboard lines are on screen
+    int32_t total;            // number of cases queued for this run
+    int32_t completed;        // number of cases finished so far
+    uint64_t started_ns;      // when the run started
+    uint64_t last_draw_ns;    // when the dashboard was last redrawn
+    uint64_t case_started_ns; // when the running case started
+    uint64_t case_total_ns;   // summed duration of finished cases
+    const fossil_bench_record_t *history; // benchmarks of an earlier run, xnull when there is none
+    uint64_t history_ns;      // earlier duration of the queued cases that have not finished
+    int32_t history_count;    // queued cases with an earlier duration that have not finished
+    const char *current;      // display name of the running case
+} progress;
+
+static bool progress_stdout_is_tty(void) {
+#if defined(_WIN32)
+    return _isatty(_fileno(stdout)) != 0;
+#else
+    return isatty(fileno(stdout)) != 0;
+#endif
+}
+
+static int32_t progress_failures(void) {
+    return _TEST_ENV.stats.expected_failed_count +
+           _TEST_ENV.stats.unexpected_failed_count +
+           _TEST_ENV.stats.unexpected_passed_count;
+}
+
+static void progress_draw(bool force) {
+    uint64_t now = fossil_test_clock_ns();
+    if (!force && progress.drawn && now - progress.last_draw_ns < PROGRESS_REDRAW_NS) {
+        return;
+    }
+    progress.last_draw_ns = now;
+
+    double elapsed = (double)(now - progress.started_ns) / 1e9;
+    double rate = elapsed > 0.0 ? (double)progress.completed / elapsed : 0.0;
+
+    // cases that ran in an earlier run are expected to take as long again, the
+    // others as long as the mean of the cases that finished, or of the earlier run
+    double eta = (double)progress.history_ns / 1e9;
+    int32_t unknown = progress.total - progress.completed - progress.history_count;
+    if (unknown > 0 && progress.completed > 0) {
+        eta += (double)progress.case_total_ns / (double)progress.completed / 1e9 * (double)unknown;
+    } else if (unknown > 0 && progress.history_count > 0) {
+        eta += (double)progress.history_ns / (double)progress.history_count / 1e9 * (double)unknown;
+    }
+
+    char bar[PROGRESS_BAR_WIDTH + 1];
+    int32_t filled = progress.total > 0 ? (progress.completed * PROGRESS_BAR_WIDTH) / progress.total : PROGRESS_BAR_WIDTH;
+    for (int32_t i = 0; i < PROGRESS_BAR_WIDTH; i++) {
+        bar[i] = i < filled ? '#' : '-';
+    }
+    bar[PROGRESS_BAR_WIDTH] = '\0';
+
+    int32_t failures = progress_failures();
+    if (progress.drawn) {
+        fprintf(console_stream(), "\033[1A"); // back to the first dashboard line
+    }
+    fprintf(console_stream(), "\r\033[K");
+    fossil_test_cout("blue", "[%s] ", bar);
+    fossil_test_cout("cyan", "%d/%d  %.1f tests/s  ", progress.completed, progress.total, rate);
+    fossil_test_cout(failures > 0 ? "red" : "green", "failures: %d  ", failures);
+    fossil_test_cout("cyan", "eta: %02d:%02d\n", (int)eta / 60, (int)eta % 60);
+    fprintf(console_stream(), "\r\033[K");
+    fossil_test_cout("blue", " worker 0 -> ");
+    fossil_test_cout("cyan", "%.*s", PROGRESS_NAME_WIDTH, progress.current != xnullptr ? progress.current : "idle");
+    fflush(console_stream());
+    progress.drawn = true;
+}
+
+bool fossil_test_io_progress_active(void) {
+    return progress.active;
+}
+
+void fossil_test_io_progress_start(const fossil_test_queue_t *queue, int32_t total) {
+    progress.active = _CLI.progress_enabled && _CLI.verbose_level == 0 && progress_stdout_is_tty();
+    progress.drawn = false;
+    progress.total = total;
+    progress.completed = 0;
+    progress.case_total_ns = 0;
+    progress.history = xnullptr;
+    progress.history_ns = 0;
+    progress.history_count = 0;
+    progress.current = xnullptr;
+    if (progress.active) {
+        progress.history = fossil_bench_history();
+        for (const fossil_test_t *test = queue->front; test != xnullptr && progress.history != xnullptr; test = test->next) {
+            uint64_t earlier = fossil_bench_history_ns(progress.history, test->name);
+            progress.history_ns += earlier;
+            progress.history_count += earlier > 0 ? 1 : 0;
+        }
+    }
+    progress.started_ns = fossil_test_clock_ns();
+    progress.case_started_ns = progress.started_ns;
+    if (progress.active) {
+        progress_draw(true);
+    }
+}
+
+void fossil_test_io_progress_update(fossil_test_t *test) {
+    if (!progress.active || test == xnullptr) {
+        return;
+    }
+    // prefer the per case timing kept for the summary over the time between updates
+    uint64_t now = fossil_test_clock_ns();
+    uint64_t elapsed = now - progress.case_started_ns;
+    if (_TEST_ENV.timing_count > 0 && _TEST_ENV.timings[_TEST_ENV.timing_count - 1].test == test) {
+        elapsed = _TEST_ENV.timings[_TEST_ENV.timing_count - 1].elapsed_ns;
+    }
+    progress.completed++;
+    progress.case_total_ns += elapsed;
+    progress.case_started_ns = now;
+
+    uint64_t earlier = progress.history != xnullptr ? fossil_bench_history_ns(progress.history, test->name) : 0;
+    if (earlier > 0) {
+        progress.history_ns -= earlier;
+        progress.history_count--;
+    }
+    progress_draw(progress.completed == progress.total);
+}
+
+void fossil_test_io_progress_ended(void) {
+    if (!progress.active) {
+        return;
+    }
+    progress.current = xnullptr;
+    progress_draw(true);
+    fprintf(console_stream(), "\n");
+    progress.active = false;
+}
+
+// ==============================================================================
+// Xtest per case output capture
+// ==============================================================================
+
+enum {
+    CAPTURE_CHUNK = 4096
+};
+
+static struct {
+    bool active;     // buffers are open for this run
+    bool redirected; // stdout/stderr currently point at the buffers
+    int saved_out;   // the real stdout and stderr
+    int saved_err;
+    int out_fd;      // per case buffers, rewound instead of reallocated
+    int err_fd;
+} capture = { false, false, -1, -1, -1, -1 };
+
+#if !defined(_WIN32)
+// Anonymous in-memory file on Linux, an unlinked temporary file elsewhere.
+static int capture_buffer(const char *name) {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+    int fd = memfd_create(name, MFD_CLOEXEC);
+    if (fd >= 0) {
+        return fd;
+    }
+#endif
+    (void)name;
+    FILE *file = tmpfile();
+    if (file == xnullptr) {
+        return -1;
+    }
+    int fd_copy = dup(fileno(file));
+    fclose(file);
+    return fd_copy;
+}
+
+// Function to print what a case wrote, then rewind the buffer for the next case
+static void capture_replay(int fd, const char *label, bool show) {
+    off_t size = lseek(fd, 0, SEEK_CUR);
+    if (size <= 0) {
+        return;
+    }
+
+    if (show) {
+        if (progress.active && progress.drawn) {
+            // clear the dashboard, it is redrawn below the captured text
+            fprintf(console_stream(), "\r\033[K\033[1A\r\033[K");
+            progress.drawn = false;
+        }
+        fossil_test_cout("blue", "captured %s:\n", label);
+
+        char chunk[CAPTURE_CHUNK];
+        char last = '\n';
+        ssize_t got;
+        lseek(fd, 0, SEEK_SET);
+        while ((got = read(fd, chunk, sizeof(chunk))) > 0) {
+            fwrite(chunk, 1, (size_t)got, console_stream());
+            last = chunk[got - 1];
+        }
+        if (last != '\n') {
+            fputc('\n', console_stream());
+        }
+    }
+
+    if (ftruncate(fd, 0) == 0) {
+        lseek(fd, 0, SEEK_SET);
+    }
+}
+
+static void capture_close(int *fd) {
+    if (*fd >= 0) {
+        close(*fd);
+        *fd = -1;
+    }
+}
+
+// A failed assert may exit in the middle of a case, keep its output visible.
+static void capture_atexit(void) {
+    fossil_test_io_capture_ended(true);
+}
+#endif
+
+bool fossil_test_io_capture_active(void) {
+    return capture.redirected;
+}
+
+void fossil_test_io_capture_start(void) {
+#if !defined(_WIN32)
+    static bool registered = false;
+    if (!_CLI.capture_enabled || capture.active) {
+        return;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    capture.saved_out = dup(STDOUT_FILENO);
+    capture.saved_err = dup(STDERR_FILENO);
+    capture.out_fd = capture_buffer("fossil-stdout");
+    capture.err_fd = capture_buffer("fossil-stderr");
+    int console_fd = dup(STDOUT_FILENO);
+    FILE *stream = console_fd >= 0 ? fdopen(console_fd, "w") : xnullptr;
+
+    if (stream == xnullptr || capture.saved_out < 0 || capture.saved_err < 0 ||
+        capture.out_fd < 0 || capture.err_fd < 0) {
+        if (stream == xnullptr && console_fd >= 0) {
+            close(console_fd);
+        } else if (stream != xnullptr) {
+            fclose(stream);
+        }
+        capture_close(&capture.saved_out);
+        capture_close(&capture.saved_err);
+        capture_close(&capture.out_fd);
+        capture_close(&capture.err_fd);
+        return; // run without capture rather than lose output
+    }
+
+    console = stream;
+    capture.active = true;
+    if (!registered) {
+        atexit(capture_atexit);
+        registered = true;
+    }
+#endif
+}
+
+void fossil_test_io_capture_begin(void) {
+#if !defined(_WIN32)
+    if (!capture.active || capture.redirected) {
+        return;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    dup2(capture.out_fd, STDOUT_FILENO);
+    dup2(capture.err_fd, STDERR_FILENO);
+    capture.redirected = true;
+#endif
+}
+
+void fossil_test_io_capture_ended(bool failed) {
+#if !defined(_WIN32)
+    if (!capture.redirected) {
+        return;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    dup2(capture.saved_out, STDOUT_FILENO);
+    dup2(capture.saved_err, STDERR_FILENO);
+    capture.redirected = false;
+
+    bool show = failed || _CLI.verbose_level == 2;
+    capture_replay(capture.out_fd, "stdout", show);
+    capture_replay(capture.err_fd, "stderr", show);
+    fflush(console_stream());
+#else
+    (void)failed;
+#endif
+}
+
+void fossil_test_io_capture_stop(void) {
+#if !defined(_WIN32)
+    if (!capture.active) {
+        return;
+    }
+    fossil_test_io_capture_ended(false);
+    fclose(console);
+    console = xnullptr;
+    capture_close(&capture.saved_out);
+    capture_close(&capture.saved_err);
+    capture_close(&capture.out_fd);
+    capture_close(&capture.err_fd);
+    capture.active = false;
+#endif
+}
+
 // Function to handle CLI information output
 void fossil_test_io_information(void) {
     if (_CLI.show_version) {
@@ -339,13 +656,35 @@ void fossil_test_io_information(void) {
         fossil_test_cout("cyan", "  only=<tag> or only=<tags>         Runs only the tests tagged with the specified tag(s)\n");
         fossil_test_cout("cyan", "  reverse [enable/disable]          Enables or disables the reverse order of test execution\n");
         fossil_test_cout("cyan", "  repeat=<number>                   Repeats the test suite for the specified number of times\n");
+        fossil_test_cout("cyan", "  bench                             Runs only benchmarks and performance cases, each repeat is a sample\n");
         fossil_test_cout("cyan", "  shuffle [enable/disable]          Enables or disables the shuffling of test execution order\n");
         fossil_test_cout("cyan", "  verbose [cutback/normal/verbose]  Sets the verbosity level of the output\n");
         fossil_test_cout("cyan", "  list                              Lists all available tests\n");
         fossil_test_cout("cyan", "  summary [enable/disable]          Enables or disables the summary of test results after execution\n");
         fossil_test_cout("cyan", "  color [enable/disable]            Enables or disables colored output in the terminal\n");
         fossil_test_cout("cyan", "  sanity [enable/disable]           Enables or disables sanity checks before running the tests\n");
+        fossil_test_cout("cyan", "  progress [enable/disable]         Enables or disables the live progress display in cutback mode\n");
+        fossil_test_cout("cyan", "  slowest <number>                  Adds the slowest cases and time distribution to the summary\n");
+        fossil_test_cout("cyan", "  capture [enable/disable]          Buffers stdout/stderr of each case and shows it only on failure\n");
+        fossil_test_cout("cyan", "  counters [enable/disable]         Reports perf counters per benchmark iteration and per test case\n");
+        fossil_test_cout("cyan", "  allocs [enable/disable]           Reports heap allocations per test case, benchmarks always count them\n");
+        fossil_test_cout("cyan", "  bench-save <file>                 Writes the benchmark samples to a baseline file after the run\n");
+        fossil_test_cout("cyan", "  bench-compare <file>              Fails benchmarks that are significantly slower than the baseline\n");
+        fossil_test_cout("cyan", "  bench-histogram <file>            Writes the latency histograms of the benchmarks after the run\n");
+        fossil_test_cout("cyan", "  bench-cpu <number>                Pins the runner to one CPU before the first benchmark\n");
+        fossil_test_cout("cyan", "  bench-priority [enable/disable]   Raises the scheduling priority before the first benchmark\n");
+        fossil_test_cout("cyan", "  bench-cold [enable/disable/branches] Also samples every benchmark with the caches evicted\n");
+        fossil_test_cout("cyan", "  bench-threads <number>            Most threads of a scaling benchmark (default: number of CPUs)\n");
+        fossil_test_cout("cyan", "  bench-threshold <percent>         Slowdown that fails a benchmark in bench-compare (default 5)\n");
+        fossil_test_cout("cyan", "  compare <old> <new> [table/json]  Compares two bench-save files without running any test\n");
+        fossil_test_cout("cyan", "  trace <file>                      Writes a Chrome trace of cases, steps and benchmark samples\n");
         exit(0);
+    } else if (_CLI.compare_enabled) {
+        if (_CLI.compare_new_file[0] == '\0') {
+            fossil_test_cout("red", "Usage: compare <old> <new> [table/json], two bench-save files are needed\n");
+            exit(2);
+        }
+        exit(fossil_bench_report(_CLI.compare_old_file, _CLI.compare_new_file, _CLI.compare_json));
     }
 }
 
@@ -361,52 +700,66 @@ void fossil_test_io_sanity_load(fossil_test_t *test) {
 
 void fossil_test_io_unittest_start(fossil_test_t *test) {
     test->timer.start = clock();
-    
-    if (_CLI.verbose_level == 2) {
+
+    if (progress.active) {
+        progress.current = display_name(test);
+        progress_draw(false);
+    }
+
+    if (_CLI.verbose_level == 2 && !_CLI.bench_mode) {
         fossil_test_cout("blue", "%s[%.4d]%s\n", "=[started case]=====================================================================",
         _TEST_ENV.stats.expected_total_count + 1, "===");
         fossil_test_cout("blue", "test name : ");
-        fossil_test_cout("cyan", " -> %s\n", replace_underscore(test->name));
+        fossil_test_cout("cyan", " -> %s\n", display_name(test));
         fossil_test_cout("blue", "priority  : ");
         fossil_test_cout("cyan", " -> %d\n", test->priority);
         fossil_test_cout("blue", "tags      : ");
         fossil_test_cout("cyan", " -> %s\n", test->tags);
         fossil_test_cout("blue", "marker    : ");
         fossil_test_cout("cyan", " -> %s\n", test->marks);
-    } else if (_CLI.verbose_level == 1) {
+    } else if (_CLI.verbose_level == 1 && !_CLI.bench_mode) {
         fossil_test_cout("blue", "[start] ");
-        fossil_test_cout("cyan", "%.4d: %s tag: %s mark: %s\n", _TEST_ENV.stats.expected_total_count + 1, replace_underscore(test->name), test->tags, test->marks);
+        fossil_test_cout("cyan", "%.4d: %s tag: %s mark: %s\n", _TEST_ENV.stats.expected_total_count + 1, display_name(test), test->tags, test->marks);
     }
 }
 
 void fossil_test_io_unittest_given(char *description) {
-    if (_CLI.verbose_level == 2) {
+    if (_TEST_TRACE.enabled) {
+        fossil_test_trace_step(0, description);
+    }
+    if (_CLI.verbose_level == 2 && !_CLI.bench_mode) {
         fossil_test_cout("blue", "          : ");
         fossil_test_cout("magenta", "%s%s\n", "GIVEN ", description);
     }
 }
 
 void fossil_test_io_unittest_when(char *description) {
-    if (_CLI.verbose_level == 2) {
+    if (_TEST_TRACE.enabled) {
+        fossil_test_trace_step(1, description);
+    }
+    if (_CLI.verbose_level == 2 && !_CLI.bench_mode) {
         fossil_test_cout("blue", "          : ");
         fossil_test_cout("magenta", "%s%s\n", "\tWHEN ", description);
     }
 }
 
 void fossil_test_io_unittest_then(char *description) {
-    if (_CLI.verbose_level == 2) {
+    if (_TEST_TRACE.enabled) {
+        fossil_test_trace_step(2, description);
+    }
+    if (_CLI.verbose_level == 2 && !_CLI.bench_mode) {
         fossil_test_cout("blue", "          : ");
         fossil_test_cout("magenta", "%s%s\n", "\t\tTHEN ", description);
     }
 }
 
 void fossil_test_io_unittest_step(xassert_info *assume) {
-    if (_CLI.verbose_level == 2) {
+    if (_CLI.verbose_level == 2 && !_CLI.bench_mode) {
         fossil_test_cout("blue", "has assert  : ");
         fossil_test_cout("cyan", " -> %s\n", assume->has_assert ? COLOR_GREEN "has assertions" COLOR_RESET : COLOR_RED "missing assertions" COLOR_RESET);
         fossil_test_cout("blue", "asserts used: ");
         fossil_test_cout("cyan", COLOR_GREEN "%3i\n" COLOR_RESET , assume->num_asserts);
-    } else if (_CLI.verbose_level == 1) {
+    } else if (_CLI.verbose_level == 1 && !_CLI.bench_mode) {
         fossil_test_cout("blue", "[intro] has_assert : ");
         fossil_test_cout("cyan", "%s\n", assume->has_assert ? COLOR_GREEN "yes" COLOR_RESET : COLOR_RED "no" COLOR_RESET);
         fossil_test_cout("blue", "[intro] same_assert: ");
@@ -419,18 +772,18 @@ void fossil_test_io_unittest_step(xassert_info *assume) {
 void fossil_test_io_unittest_ended(fossil_test_t *test) {
     calculate_elapsed_time(&test->timer);
 
-    if (_CLI.verbose_level == 2) {
+    if (_CLI.verbose_level == 2 && !_CLI.bench_mode) {
         fossil_test_cout("blue", "timestamp : ");
         fossil_test_cout("cyan", " -> %ld minutes, %ld seconds, %ld milliseconds, %ld microseconds, %ld nanoseconds\n",
             (uint32_t)test->timer.detail.minutes, (uint32_t)test->timer.detail.seconds, (uint32_t)test->timer.detail.milliseconds,
             (uint32_t)test->timer.detail.microseconds, (uint32_t)test->timer.detail.nanoseconds);
         fossil_test_cout("blue", "%s\n", "=[ ended case ]==============================================================================");
-    } else if (_CLI.verbose_level == 1) {
+    } else if (_CLI.verbose_level == 1 && !_CLI.bench_mode) {
         fossil_test_cout("blue", "[ended] time: ");
         fossil_test_cout("cyan", "%ld:%ld:%ld:%ld:%ld\n",
             (uint32_t)test->timer.detail.minutes, (uint32_t)test->timer.detail.seconds, (uint32_t)test->timer.detail.milliseconds,
             (uint32_t)test->timer.detail.microseconds, (uint32_t)test->timer.detail.nanoseconds);
-    } else if (_CLI.verbose_level == 0 && !_ASSERT_INFO.should_fail) {
+    } else if (_CLI.verbose_level == 0 && !_ASSERT_INFO.should_fail && !fossil_test_io_progress_active()) {
         fossil_test_cout("green", "[#]");
     }
 
@@ -440,6 +793,156 @@ void fossil_test_io_unittest_ended(fossil_test_t *test) {
     }
 }
 
+// ==============================================================================
+// Xtest failure diff rendering
+// ==============================================================================
+
+enum {
+    DIFF_HEX_ROW = 16,     // bytes per hexdump row
+    DIFF_CONTEXT_ROWS = 2, // rows or lines shown before the first difference
+    DIFF_MAX_ROWS = 16,    // cap on rendered rows so large values stay readable
+    DIFF_TEXT_WIDTH = 40   // columns shown per side of a text diff
+};
+
+static void diff_hex_side(char *out, size_t size, const unsigned char *data, size_t length, size_t offset) {
+    size_t used = 0;
+    for (size_t i = 0; i < DIFF_HEX_ROW && used < size; i++) {
+        if (offset + i < length) {
+            used += (size_t)snprintf(out + used, size - used, "%02x ", data[offset + i]);
+        } else {
+            used += (size_t)snprintf(out + used, size - used, "   ");
+        }
+    }
+}
+
+static void diff_render_bytes(const xassert_operands_t *operands, bool full) {
+    const unsigned char *actual = (const unsigned char*)operands->actual;
+    const unsigned char *expected = (const unsigned char*)operands->expected;
+    if (actual == xnullptr || expected == xnullptr) {
+        fossil_test_cout("red", "operands : -> actual %p, expected %p\n", operands->actual, operands->expected);
+        return;
+    }
+
+    size_t actual_size = operands->actual_size;
+    size_t expected_size = operands->expected_size;
+    size_t length = actual_size < expected_size ? actual_size : expected_size;
+    size_t longest = actual_size < expected_size ? expected_size : actual_size;
+    size_t first = longest;
+    size_t differ = longest - length; // bytes past the shorter operand differ too
+    for (size_t i = 0; i < length; i++) {
+        if (actual[i] != expected[i]) {
+            first = first == longest ? i : first;
+            differ++;
+        }
+    }
+    if (first == longest && differ > 0) {
+        first = length; // the first byte past the shorter operand
+    }
+    if (actual_size != expected_size) {
+        fossil_test_cout("red", "operands : -> actual %zu bytes, expected %zu bytes, %zu differ, first at offset 0x%zx\n",
+            actual_size, expected_size, differ, first);
+    } else {
+        fossil_test_cout("red", "operands : -> %zu bytes, %zu differ, first at offset 0x%zx\n", length, differ, first);
+    }
+    if (!full || differ == 0) {
+        return;
+    }
+
+    size_t rows = (longest + DIFF_HEX_ROW - 1) / DIFF_HEX_ROW;
+    size_t begin = first / DIFF_HEX_ROW > DIFF_CONTEXT_ROWS ? first / DIFF_HEX_ROW - DIFF_CONTEXT_ROWS : 0;
+    size_t end = begin + DIFF_MAX_ROWS < rows ? begin + DIFF_MAX_ROWS : rows;
+    char lhs[DIFF_HEX_ROW * 3 + 1];
+    char rhs[DIFF_HEX_ROW * 3 + 1];
+
+    fossil_test_cout("red", "  offset    %-*s| %s\n", DIFF_HEX_ROW * 3, "actual", "expected");
+    for (size_t row = begin; row < end; row++) {
+        size_t offset = row * DIFF_HEX_ROW;
+        size_t row_end = offset + DIFF_HEX_ROW < longest ? offset + DIFF_HEX_ROW : longest;
+        // a row reaching past either operand is never the same
+        bool same = row_end <= length && memcmp(actual + offset, expected + offset, row_end - offset) == 0;
+        diff_hex_side(lhs, sizeof(lhs), actual, actual_size, offset);
+        diff_hex_side(rhs, sizeof(rhs), expected, expected_size, offset);
+        fossil_test_cout(same ? "cyan" : "red", "%c %08zx  %s| %s\n", same ? ' ' : '>', offset, lhs, rhs);
+    }
+    if (end < rows) {
+        fossil_test_cout("red", "  ... %zu more row(s) not shown\n", rows - end);
+    }
+}
+
+// Length of the line starting at text, without the newline
+static size_t diff_line_length(const char *text) {
+    size_t length = 0;
+    while (text[length] != '\0' && text[length] != '\n') {
+        length++;
+    }
+    return length;
+}
+
+static void diff_render_text(const xassert_operands_t *operands, bool full) {
+    const char *actual = (const char*)operands->actual;
+    const char *expected = (const char*)operands->expected;
+    if (actual == xnullptr || expected == xnullptr) {
+        fossil_test_cout("red", "operands : -> actual %s, expected %s\n",
+            actual != xnullptr ? "set" : "(null)", expected != xnullptr ? "set" : "(null)");
+        return;
+    }
+
+    // the common prefix gives the first differing line and column
+    size_t index = 0;
+    size_t line = 1;
+    size_t line_start = 0;
+    while (actual[index] != '\0' && actual[index] == expected[index]) {
+        if (actual[index] == '\n') {
+            line++;
+            line_start = index + 1;
+        }
+        index++;
+    }
+    fossil_test_cout("red", "operands : -> text, first difference at line %zu column %zu\n", line, index - line_start + 1);
+    if (!full) {
+        return;
+    }
+
+    // walk back a few lines of context, the prefix is shared by both sides
+    size_t begin = line_start;
+    size_t first_line = line;
+    while (begin > 0 && line - first_line < DIFF_CONTEXT_ROWS) {
+        begin--;
+        while (begin > 0 && actual[begin - 1] != '\n') {
+            begin--;
+        }
+        first_line--;
+    }
+
+    const char *lhs = actual + begin;
+    const char *rhs = expected + begin;
+    fossil_test_cout("red", "  line  %-*s | %s\n", DIFF_TEXT_WIDTH, "actual", "expected");
+    size_t shown = 0;
+    while ((*lhs != '\0' || *rhs != '\0') && shown < DIFF_MAX_ROWS) {
+        size_t lhs_length = diff_line_length(lhs);
+        size_t rhs_length = diff_line_length(rhs);
+        bool same = lhs_length == rhs_length && memcmp(lhs, rhs, lhs_length) == 0;
+        fossil_test_cout(same ? "cyan" : "red", "%c %4zu  %-*.*s | %.*s\n", same ? ' ' : '>', first_line + shown,
+            DIFF_TEXT_WIDTH, (int)(lhs_length < DIFF_TEXT_WIDTH ? lhs_length : DIFF_TEXT_WIDTH), lhs,
+            (int)(rhs_length < DIFF_TEXT_WIDTH ? rhs_length : DIFF_TEXT_WIDTH), rhs);
+        lhs += lhs_length + (lhs[lhs_length] == '\n');
+        rhs += rhs_length + (rhs[rhs_length] == '\n');
+        shown++;
+    }
+    if (*lhs != '\0' || *rhs != '\0') {
+        fossil_test_cout("red", "  ... more lines not shown\n");
+    }
+}
+
+// Renders the operands of a failed comparison, the diff is only worked out here
+static void fossil_test_io_operands(const xassert_operands_t *operands, bool full) {
+    if (operands->kind == TEST_OPERAND_AS_BYTES) {
+        diff_render_bytes(operands, full);
+    } else if (operands->kind == TEST_OPERAND_AS_TEXT) {
+        diff_render_text(operands, full);
+    }
+}
+
 void fossil_test_io_asserted(xassert_info *assume) {
     if (_CLI.verbose_level == 2) {
         fossil_test_cout("red", "=[F]=[assertion failed]======================================================================\n");
@@ -447,19 +950,745 @@ void fossil_test_io_asserted(xassert_info *assume) {
         fossil_test_cout("red", "file name: -> %s\n", assume->file);
         fossil_test_cout("red", "line num : -> %d\n", assume->line);
         fossil_test_cout("red", "function : -> %s\n", assume->func);
+        fossil_test_io_operands(&assume->operands, true);
         fossil_test_cout("red", "=========================================================================================[F]=\n");
     } else if (_CLI.verbose_level == 1) {
         fossil_test_cout("red", "name: %s line: -> %d msg: -> %s\n", assume->func, assume->line, assume->message);
-    } else {
+        fossil_test_io_operands(&assume->operands, false);
+    } else if (!fossil_test_io_progress_active()) {
         fossil_test_cout("red", "[#]");
     }
 }
 
+// Formats a size in bytes with a binary unit into the given buffer
+static const char *format_bench_bytes(size_t bytes, char *buffer, size_t size) {
+    if (bytes >= 1024 * 1024 && bytes % (1024 * 1024) == 0) {
+        snprintf(buffer, size, "%llu MiB", (unsigned long long)(bytes / (1024 * 1024)));
+    } else if (bytes >= 1024) {
+        snprintf(buffer, size, "%llu KiB", (unsigned long long)(bytes / 1024));
+    } else {
+        snprintf(buffer, size, "%llu B", (unsigned long long)bytes);
+    }
+    return buffer;
+}
+
 void fossil_test_io_summary_start(void) {
     fossil_test_cout("blue", "=============================================================================================\n");
     fossil_test_cout("blue", "%s\n", "platform meta data about the host system:");
     fossil_test_cout("blue", "endian(%6s) cpus(%2i) memory(%4i) os(%s) arch(%s)\n",
     _fossil_test_assert_is_big_endian() ? "big" : "little", _fossil_test_get_num_cpus(), _fossil_test_get_memory_size(), _fossil_test_get_os_name(), _fossil_test_get_architecture());
+    double load[3] = {0.0, 0.0, 0.0};
+    int mhz = _fossil_test_get_cpu_mhz();
+    const char *governor = _fossil_test_get_cpu_governor();
+    fossil_test_cout("blue", "cpu(%s) ", _fossil_test_get_cpu_model());
+    if (mhz > 0) {
+        fossil_test_cout("blue", "freq(%d MHz) ", mhz);
+    }
+    fossil_test_cout("blue", "kernel(%s)", _fossil_test_get_kernel());
+    if (_fossil_test_get_load_average(load)) {
+        fossil_test_cout("blue", " load(%.2f %.2f %.2f)", load[0], load[1], load[2]);
+    }
+    if (governor[0] != '\0') {
+        fossil_test_cout("blue", " governor(%s)", governor);
+    }
+    if (_fossil_test_get_cache_size(1) > 0) {
+        char cache[32];
+        fossil_test_cout("blue", " cache(line %llu", (unsigned long long)_fossil_test_get_cache_line_size());
+        for (int32_t level = 1; level <= 3; level++) {
+            if (_fossil_test_get_cache_size(level) > 0) {
+                fossil_test_cout("blue", " L%d %s", level, format_bench_bytes(_fossil_test_get_cache_size(level), cache, sizeof(cache)));
+            }
+        }
+        fossil_test_cout("blue", ")");
+    }
+    fossil_test_cout("blue", "\n");
+    fossil_test_cout("blue", "=============================================================================================\n");
+}
+
+// ==============================================================================
+// Xtest timing section of the summary
+// ==============================================================================
+
+typedef struct {
+    const char *name;
+    int32_t count;
+    uint64_t total_ns;
+} timing_bucket_t;
+
+// Totals per tag or per group. Sized from the arena for the run, where every
+// case could bring a key of its own, so cases are only left out when the
+// arena is exhausted.
+typedef struct {
+    timing_bucket_t *buckets;
+    int32_t used;
+    int32_t capacity;
+    int32_t dropped; // cases that found no free bucket
+} timing_table_t;
+
+// Formats a duration with a readable unit into the given buffer
+static const char* format_duration(uint64_t ns, char *buffer, size_t size) {
+    if (ns >= 1000000000ULL) {
+        snprintf(buffer, size, "%8.3f s ", (double)ns / 1e9);
+    } else if (ns >= 1000000ULL) {
+        snprintf(buffer, size, "%8.3f ms", (double)ns / 1e6);
+    } else if (ns >= 1000ULL) {
+        snprintf(buffer, size, "%8.3f us", (double)ns / 1e3);
+    } else {
+        snprintf(buffer, size, "%8llu ns", (unsigned long long)ns);
+    }
+    return buffer;
+}
+
+static int timing_compare_desc(const void *lhs, const void *rhs) {
+    uint64_t a = ((const fossil_test_timing_t*)lhs)->elapsed_ns;
+    uint64_t b = ((const fossil_test_timing_t*)rhs)->elapsed_ns;
+    return (a < b) - (a > b);
+}
+
+// Nearest rank percentile over timings sorted slowest first
+static uint64_t timing_percentile(const fossil_test_timing_t *sorted, int32_t count, double pct) {
+    int32_t rank = (int32_t)ceil(pct / 100.0 * (double)count);
+    if (rank < 1) {
+        rank = 1;
+    }
+    return sorted[count - rank].elapsed_ns;
+}
+
+static void timing_table_open(timing_table_t *table, int32_t count) {
+    table->buckets = (timing_bucket_t*)fossil_test_arena_alloc(&_TEST_ENV.arena, (size_t)count * sizeof(timing_bucket_t));
+    table->used = 0;
+    table->capacity = table->buckets != xnullptr ? count : 0;
+    table->dropped = 0;
+}
+
+static void timing_table_add(timing_table_t *table, const char *name, uint64_t ns) {
+    if (name == xnullptr) {
+        name = "(none)";
+    }
+    for (int32_t i = 0; i < table->used; i++) {
+        if (table->buckets[i].name == name || strcmp(table->buckets[i].name, name) == 0) {
+            table->buckets[i].count++;
+            table->buckets[i].total_ns += ns;
+            return;
+        }
+    }
+    if (table->used == table->capacity) {
+        table->dropped++;
+        return;
+    }
+    table->buckets[table->used].name = name;
+    table->buckets[table->used].count = 1;
+    table->buckets[table->used].total_ns = ns;
+    table->used++;
+}
+
+static void timing_table_print(const char *title, const timing_table_t *table) {
+    char duration[32];
+    fossil_test_cout("blue", "%s\n", title);
+    for (int32_t i = 0; i < table->used; i++) {
+        fossil_test_cout("cyan", "  %-32s %6d cases %s\n", table->buckets[i].name, table->buckets[i].count,
+            format_duration(table->buckets[i].total_ns, duration, sizeof(duration)));
+    }
+    if (table->dropped > 0) {
+        fossil_test_cout("cyan", "  ... %d more case(s) not shown\n", table->dropped);
+    }
+}
+
+void fossil_test_io_timings(fossil_test_timing_t *timings, int32_t count) {
+    if (timings == xnullptr || count <= 0) {
+        return;
+    }
+
+    // the timings are only sorted once all cases have run
+    fossil_test_timing_t *sorted = timings;
+    qsort(sorted, (size_t)count, sizeof(fossil_test_timing_t), timing_compare_desc);
+
+    char duration[32];
+    int32_t shown = _CLI.slowest_count < count ? _CLI.slowest_count : count;
+    fossil_test_cout("blue", "=============================================================================================\n");
+    fossil_test_cout("blue", "slowest test cases:\n");
+    for (int32_t i = 0; i < shown; i++) {
+        const fossil_test_t *test = sorted[i].test;
+        fossil_test_cout("cyan", "  %3d. %s  %s (%s)\n", i + 1,
+            format_duration(sorted[i].elapsed_ns, duration, sizeof(duration)), display_name(test), test->tags);
+    }
+
+    fossil_test_cout("blue", "test duration distribution:\n");
+    fossil_test_cout("cyan", "  p50 %s", format_duration(timing_percentile(sorted, count, 50.0), duration, sizeof(duration)));
+    fossil_test_cout("cyan", "  p90 %s", format_duration(timing_percentile(sorted, count, 90.0), duration, sizeof(duration)));
+    fossil_test_cout("cyan", "  p99 %s", format_duration(timing_percentile(sorted, count, 99.0), duration, sizeof(duration)));
+    fossil_test_cout("cyan", "  max %s\n", format_duration(sorted[0].elapsed_ns, duration, sizeof(duration)));
+
+    timing_table_t tags;
+    timing_table_t groups;
+    timing_table_open(&tags, count);
+    timing_table_open(&groups, count);
+    for (int32_t i = 0; i < count; i++) {
+        timing_table_add(&tags, sorted[i].test->tags, sorted[i].elapsed_ns);
+        timing_table_add(&groups, sorted[i].test->group, sorted[i].elapsed_ns);
+    }
+    timing_table_print("time per tag:", &tags);
+    timing_table_print("time per group:", &groups);
+}
+
+// ==============================================================================
+// Xtest benchmark results
+// ==============================================================================
+
+// Formats a per iteration time, which is often a fraction of a nanosecond
+static const char* format_bench_time(double ns, char *buffer, size_t size) {
+    if (ns >= 1e9) {
+        snprintf(buffer, size, "%8.3f s ", ns / 1e9);
+    } else if (ns >= 1e6) {
+        snprintf(buffer, size, "%8.3f ms", ns / 1e6);
+    } else if (ns >= 1e3) {
+        snprintf(buffer, size, "%8.3f us", ns / 1e3);
+    } else {
+        snprintf(buffer, size, "%8.3f ns", ns);
+    }
+    return buffer;
+}
+
+// Formats a rate per second with a decimal prefix, "412.50 MB/s" or "3.10 M items/s"
+static const char* format_bench_rate(double rate, const char *unit, char *buffer, size_t size) {
+    const char *prefix = "";
+    if (rate >= 1e9) {
+        prefix = "G";
+        rate /= 1e9;
+    } else if (rate >= 1e6) {
+        prefix = "M";
+        rate /= 1e6;
+    } else if (rate >= 1e3) {
+        prefix = "k";
+        rate /= 1e3;
+    }
+    const char *gap = prefix[0] != '\0' && strcmp(unit, "B") != 0 ? " " : "";
+    snprintf(buffer, size, "%8.2f %s%s%s/s", rate, prefix, gap, unit);
+    return buffer;
+}
+
+static void bench_io_rate(const fossil_bench_rate_t *rate, const char *unit) {
+    char median[32];
+    char mad[32];
+    if (rate->per_iteration == 0) {
+        return;
+    }
+    fossil_test_cout("blue", "[rate] ");
+    fossil_test_cout("cyan", "median %s +/- %s  (%llu %s per iteration)\n", format_bench_rate(rate->median, unit, median, sizeof(median)),
+        format_bench_rate(rate->mad, unit, mad, sizeof(mad)), (unsigned long long)rate->per_iteration, unit[0] == 'B' ? "bytes" : unit);
+}
+
+static const char *bench_verdict_name(fossil_bench_verdict_t verdict) {
+    switch (verdict) {
+        case FOSSIL_BENCH_VERDICT_SAME:   return "same";
+        case FOSSIL_BENCH_VERDICT_FASTER: return "faster";
+        case FOSSIL_BENCH_VERDICT_SLOWER: return "slower";
+        default:                          return "new";
+    }
+}
+
+static const char *bench_verdict_color(fossil_bench_verdict_t verdict) {
+    switch (verdict) {
+        case FOSSIL_BENCH_VERDICT_FASTER: return "green";
+        case FOSSIL_BENCH_VERDICT_SLOWER: return "red";
+        default:                          return "cyan";
+    }
+}
+
+// Formats the confidence interval of a change, "[-1.2%, +3.4%]"
+static const char *format_bench_interval(const fossil_bench_compare_t *compare, char *buffer, size_t size) {
+    snprintf(buffer, size, "[%+.1f%%, %+.1f%%]", compare->delta_low * 100.0, compare->delta_high * 100.0);
+    return buffer;
+}
+
+// One row of a comparison table, either side may be missing
+static void bench_io_compare_row(const char *name, bool has_before, double before_ns, bool has_after, double after_ns,
+    const fossil_bench_compare_t *compare) {
+    char before[32];
+    char after[32];
+    char interval[48];
+    if (!has_before || !has_after) {
+        fossil_test_cout("cyan", "  %-28.28s %11s %11s %9s %18s %9s %8s\n", name,
+            has_before ? format_bench_time(before_ns, before, sizeof(before)) : "-",
+            has_after ? format_bench_time(after_ns, after, sizeof(after)) : "-", "-", "-", "-", has_after ? "new" : "removed");
+        return;
+    }
+    fossil_test_cout(bench_verdict_color(compare->verdict), "  %-28.28s %s %s %+8.1f%% %18s %9.3g %8s\n", name,
+        format_bench_time(before_ns, before, sizeof(before)), format_bench_time(after_ns, after, sizeof(after)),
+        compare->delta * 100.0, format_bench_interval(compare, interval, sizeof(interval)), compare->p_value,
+        bench_verdict_name(compare->verdict));
+}
+
+// Percentiles of a latency histogram, the tail up to p99.999 and the maximum
+static const double bench_latency_percentiles[] = { 50.0, 90.0, 99.0, 99.9, 99.99, 99.999 };
+static const char *const bench_latency_names[] = { "p50", "p90", "p99", "p99.9", "p99.99", "p99.999" };
+
+static void bench_io_latency(const fossil_bench_histogram_t *latency) {
+    char value[32];
+    if (latency == xnullptr || latency->count == 0) {
+        return;
+    }
+    fossil_test_cout("blue", "[latency] ");
+    for (size_t i = 0; i < sizeof(bench_latency_percentiles) / sizeof(bench_latency_percentiles[0]); i++) {
+        format_bench_time((double)fossil_bench_histogram_percentile(latency, bench_latency_percentiles[i]), value, sizeof(value));
+        fossil_test_cout("cyan", "%s %s  ", bench_latency_names[i], value + strspn(value, " "));
+    }
+    format_bench_time((double)latency->max, value, sizeof(value));
+    fossil_test_cout("cyan", "max %s  (%llu operations)\n", value + strspn(value, " "), (unsigned long long)latency->count);
+}
+
+static void bench_io_latency_row(const char *name, const fossil_bench_histogram_t *latency) {
+    char value[32];
+    fossil_test_cout("cyan", "  %-28.28s %11llu", name, (unsigned long long)latency->count);
+    for (size_t i = 0; i < sizeof(bench_latency_percentiles) / sizeof(bench_latency_percentiles[0]); i++) {
+        fossil_test_cout("cyan", " %s", format_bench_time((double)fossil_bench_histogram_percentile(latency, bench_latency_percentiles[i]),
+            value, sizeof(value)));
+    }
+    fossil_test_cout("cyan", " %s\n", format_bench_time((double)latency->max, value, sizeof(value)));
+}
+
+// How the caches were made cold, for the [cold] line
+static const char *bench_cold_method(const fossil_bench_t *bench) {
+    bool branches = bench->cold_branches || _CLI.bench_cold_branches;
+    if (bench->cold_data != xnullptr) {
+        return branches ? "range flushed, branches disturbed" : "range flushed";
+    }
+    return branches ? "caches evicted, branches disturbed" : "caches evicted";
+}
+
+static void bench_io_cold(const fossil_bench_t *bench) {
+    char median[32];
+    char mad[32];
+    if (bench->cold_count == 0) {
+        return;
+    }
+    fossil_test_cout("blue", "[cold] ");
+    fossil_test_cout("cyan", "median %s +/- %s  %.1fx warm  (%d samples x 1 iteration, %s)\n",
+        format_bench_time(bench->cold_stats.median_ns, median, sizeof(median)),
+        format_bench_time(bench->cold_stats.mad_ns, mad, sizeof(mad)),
+        bench->stats.median_ns > 0.0 ? bench->cold_stats.median_ns / bench->stats.median_ns : 0.0,
+        bench->cold_stats.samples, bench_cold_method(bench));
+}
+
+void fossil_test_io_bench_result(const fossil_bench_t *bench) {
+    if (_CLI.verbose_level == 0) {
+        return;
+    }
+    char median[32];
+    char mad[32];
+    fossil_test_cout("blue", "[bench] ");
+    if (_CLI.bench_mode) {
+        fossil_test_cout("cyan", "%s ", bench->name); // there is no start line to tell the cases apart
+    } else if (bench->arg > 0) {
+        fossil_test_cout("cyan", "n=%lld ", (long long)bench->arg);
+    } else if (bench->variant_name != xnullptr) {
+        fossil_test_cout("cyan", "%s ", bench->variant_name);
+    }
+    fossil_test_cout("cyan", "median %s +/- %s  (%d samples x %llu iterations, %d outliers)\n",
+        format_bench_time(bench->stats.median_ns, median, sizeof(median)),
+        format_bench_time(bench->stats.mad_ns, mad, sizeof(mad)),
+        bench->stats.samples, (unsigned long long)bench->iterations, bench->stats.outliers);
+    bench_io_cold(bench);
+    bench_io_rate(&bench->processed_bytes, "B");
+    bench_io_rate(&bench->processed_items, "items");
+    bench_io_latency(bench->latency);
+    if (bench->compare.verdict != FOSSIL_BENCH_VERDICT_NONE) {
+        char interval[48];
+        fossil_test_cout("blue", "[compare] ");
+        fossil_test_cout(bench_verdict_color(bench->compare.verdict), "%+.1f%% %s against baseline median %s (p = %.3g, %s)\n",
+            bench->compare.delta * 100.0, format_bench_interval(&bench->compare, interval, sizeof(interval)),
+            format_bench_time(bench->compare.baseline_median_ns, median, sizeof(median)),
+            bench->compare.p_value, bench_verdict_name(bench->compare.verdict));
+    }
+    if (bench->alloc_iterations > 0) {
+        fossil_test_io_allocs(&bench->allocs, bench->alloc_iterations);
+    }
+    if (bench->counted_iterations > 0) {
+        fossil_test_io_counters(&bench->counters, bench->counted_iterations);
+    }
+}
+
+void fossil_test_io_bench_fit(const fossil_bench_range_t *range) {
+    if (_CLI.verbose_level == 0 || !range->fit.valid) {
+        return;
+    }
+    fossil_test_cout("blue", "[fit] ");
+    fossil_test_cout(range->fit.complexity == FOSSIL_BENCH_O_N_SQUARED ? "yellow" : "cyan", "%s, %.4g ns * f(n), rms %.1f%% over %d sizes\n",
+        fossil_bench_complexity_name(range->fit.complexity), range->fit.coefficient_ns, range->fit.rms * 100.0, range->point_count);
+}
+
+// Writes "name value" pairs for every counted event, per operation
+static void counters_format(char *out, size_t size, const fossil_bench_counters_t *counters, uint64_t operations) {
+    size_t used = 0;
+    out[0] = '\0';
+    double ops = operations > 0 ? (double)operations : 1.0;
+    for (int32_t i = 0; i < FOSSIL_BENCH_COUNTER_COUNT && used < size; i++) {
+        if (counters->valid[i]) {
+            used += (size_t)snprintf(out + used, size - used, "%s %.*f  ", fossil_bench_counters_name((fossil_bench_counter_t)i),
+                operations > 1 ? 2 : 0, (double)counters->value[i] / ops);
+        }
+    }
+    if (used < size && counters->valid[FOSSIL_BENCH_COUNTER_CYCLES] && counters->valid[FOSSIL_BENCH_COUNTER_INSTRUCTIONS] &&
+        counters->value[FOSSIL_BENCH_COUNTER_CYCLES] > 0) {
+        snprintf(out + used, size - used, "ipc %.2f", (double)counters->value[FOSSIL_BENCH_COUNTER_INSTRUCTIONS] /
+            (double)counters->value[FOSSIL_BENCH_COUNTER_CYCLES]);
+    }
+}
+
+void fossil_test_io_counters(const fossil_bench_counters_t *counters, uint64_t operations) {
+    if (_CLI.verbose_level == 0) {
+        return;
+    }
+    char line[256];
+    counters_format(line, sizeof(line), counters, operations);
+    if (line[0] != '\0') {
+        fossil_test_cout("blue", "[perf] ");
+        fossil_test_cout("cyan", "%s%s\n", operations > 1 ? "per iteration: " : "", line);
+    }
+}
+
+// Prints one row of an A/B table, the speedup is the reference median over the variant median
+static void bench_io_ab_row(const fossil_bench_ab_t *ab, int32_t index, const char *indent) {
+    char median[32];
+    char interval[48];
+    const fossil_bench_t *point = ab->points[index];
+    const fossil_bench_compare_t *versus = &ab->versus[index];
+    fossil_test_cout("cyan", "%s%-20.20s %12s", indent, ab->variants[index], format_bench_time(point->stats.median_ns, median, sizeof(median)));
+    if (index == 0) {
+        fossil_test_cout("cyan", " %9s\n", "reference");
+        return;
+    }
+    double speedup = 1.0 + versus->delta > 0.0 ? 1.0 / (1.0 + versus->delta) : 0.0;
+    double low = 1.0 + versus->delta_high > 0.0 ? 1.0 / (1.0 + versus->delta_high) : 0.0;
+    double high = 1.0 + versus->delta_low > 0.0 ? 1.0 / (1.0 + versus->delta_low) : 0.0;
+    snprintf(interval, sizeof(interval), "[%.3fx, %.3fx]", low, high);
+    fossil_test_cout(bench_verdict_color(versus->verdict), " %8.3fx %22s %9.3g %8s\n", speedup, interval, versus->p_value,
+        bench_verdict_name(versus->verdict));
+}
+
+void fossil_test_io_bench_ab(const fossil_bench_ab_t *ab) {
+    if (_CLI.verbose_level == 0) {
+        return;
+    }
+    fossil_test_cout("blue", "[ab] %-20s %12s %9s %22s %9s %8s\n", "variant", "median", "speedup", "95% ci", "p", "verdict");
+    for (int32_t i = 0; i < ab->variant_count; i++) {
+        bench_io_ab_row(ab, i, "[ab] ");
+    }
+}
+
+// Prints one row of a scaling table
+static void bench_io_scaling_point(const fossil_bench_scaling_point_t *point, const char *indent, bool tail) {
+    char rate[32];
+    char latency[32];
+    char p99[32];
+    fossil_test_cout(point->efficiency < 0.5 && point->threads > 1 ? "yellow" : "cyan", "%s%7d %16s %12s %9.1f%%%s%s\n", indent, point->threads,
+        format_bench_rate(point->ops_per_second, "ops", rate, sizeof(rate)),
+        format_bench_time(point->latency_ns, latency, sizeof(latency)), point->efficiency * 100.0,
+        tail ? " " : "", tail ? format_bench_time(point->p99_ns, p99, sizeof(p99)) : "");
+}
+
+void fossil_test_io_bench_scaling(const fossil_bench_scaling_t *scaling) {
+    if (_CLI.verbose_level == 0) {
+        return;
+    }
+    fossil_test_cout("blue", "[scale] ");
+    fossil_test_cout("cyan", "%llu iterations per thread and round, %d rounds\n", (unsigned long long)scaling->bench.iterations,
+        FOSSIL_BENCH_SCALING_ROUNDS);
+    bool tail = scaling->bench.latency != xnullptr;
+    fossil_test_cout("blue", "[scale] %7s %16s %12s %10s%s\n", "threads", "throughput", "latency", "efficiency", tail ? "         p99" : "");
+    for (int32_t i = 0; i < scaling->point_count; i++) {
+        bench_io_scaling_point(&scaling->points[i], "[scale] ", tail);
+    }
+}
+
+// Prints one row of a working set table, the ratio is above over below
+static void bench_io_working_set_level(const fossil_bench_working_set_level_t *level, const char *indent) {
+    char cache[32];
+    char below[32];
+    char above[32];
+    if (level->cache_bytes == 0 || level->below == xnullptr) {
+        return;
+    }
+    double ratio = level->above != xnullptr && level->below->stats.median_ns > 0.0
+        ? level->above->stats.median_ns / level->below->stats.median_ns : 0.0;
+    fossil_test_cout("cyan", "%sL%d %10s %12s %12s", indent, level->level, format_bench_bytes(level->cache_bytes, cache, sizeof(cache)),
+        format_bench_time(level->below->stats.median_ns, below, sizeof(below)),
+        level->above != xnullptr ? format_bench_time(level->above->stats.median_ns, above, sizeof(above)) : "-");
+    if (ratio > 0.0) {
+        fossil_test_cout(ratio >= 1.5 ? "yellow" : "cyan", " %8.2fx\n", ratio);
+    } else {
+        fossil_test_cout("cyan", " %9s\n", "-");
+    }
+}
+
+void fossil_test_io_bench_working_set(const fossil_bench_working_set_t *working_set) {
+    if (_CLI.verbose_level == 0) {
+        return;
+    }
+    fossil_test_cout("blue", "[cache] %-2s %10s %12s %12s %9s\n", "", "size", "fits", "spills", "slowdown");
+    for (int32_t i = 0; i < FOSSIL_BENCH_WORKING_SET_LEVELS; i++) {
+        bench_io_working_set_level(&working_set->levels[i], "[cache] ");
+    }
+}
+
+void fossil_test_io_allocs(const fossil_test_allocs_t *allocs, uint64_t operations) {
+    if (_CLI.verbose_level == 0 || !allocs->valid) {
+        return;
+    }
+    fossil_test_cout("blue", "[alloc] ");
+    if (operations > 1) {
+        fossil_test_cout("cyan", "per iteration: %.2f allocs  %.1f bytes  peak %lld bytes\n",
+            (double)allocs->allocs / (double)operations, (double)allocs->bytes / (double)operations, (long long)allocs->peak_bytes);
+    } else {
+        fossil_test_cout("cyan", "%llu allocs  %llu frees  %llu bytes  peak %lld bytes\n", (unsigned long long)allocs->allocs,
+            (unsigned long long)allocs->frees, (unsigned long long)allocs->bytes, (long long)allocs->peak_bytes);
+    }
+}
+
+static void fossil_test_io_summary_benches(void) {
+    char min[32];
+    char median[32];
+    char mean[32];
+    char mad[32];
+    char p99[32];
+    fossil_test_cout("blue", "=============================================================================================\n");
+    fossil_test_cout("blue", "benchmarks (time per iteration, clock: %s %.3f ns/tick, overhead %.1f ns subtracted):\n",
+        _BENCH_CLOCK.source, _BENCH_CLOCK.ns_per_tick, (double)_BENCH_CLOCK.overhead_ticks * _BENCH_CLOCK.ns_per_tick);
+    fossil_test_cout("blue", "  %-28s %11s %11s %11s %11s %11s %8s\n", "name", "min", "median", "mean", "mad", "p99", "outliers");
+    for (const fossil_bench_t *bench = _TEST_ENV.benches; bench != xnullptr; bench = bench->next) {
+        fossil_test_cout("cyan", "  %-28.28s %s %s %s %s %s %4d/%-3d\n", bench->name,
+            format_bench_time(bench->stats.min_ns, min, sizeof(min)),
+            format_bench_time(bench->stats.median_ns, median, sizeof(median)),
+            format_bench_time(bench->stats.mean_ns, mean, sizeof(mean)),
+            format_bench_time(bench->stats.mad_ns, mad, sizeof(mad)),
+            format_bench_time(bench->stats.p99_ns, p99, sizeof(p99)),
+            bench->stats.outliers, bench->stats.samples + bench->stats.outliers);
+    }
+
+    for (const fossil_bench_scaling_t *scaling = _TEST_ENV.scalings; scaling != xnullptr; scaling = scaling->next) {
+        fossil_test_cout("blue", "benchmark scaling of %s (aggregate throughput, latency per thread, parallel efficiency):\n", scaling->bench.name);
+        bool tail = scaling->bench.latency != xnullptr;
+        fossil_test_cout("blue", "  %7s %16s %12s %10s%s\n", "threads", "throughput", "latency", "efficiency", tail ? "         p99" : "");
+        for (int32_t i = 0; i < scaling->point_count; i++) {
+            bench_io_scaling_point(&scaling->points[i], "  ", tail);
+        }
+    }
+
+    for (const fossil_bench_ab_t *ab = _TEST_ENV.ab_benches; ab != xnullptr; ab = ab->next) {
+        if (ab->variant_count == 0) {
+            continue;
+        }
+        fossil_test_cout("blue", "benchmark A/B of %s (interleaved samples, speedup over %s with 95%% ci):\n", ab->bench.name, ab->variants[0]);
+        fossil_test_cout("blue", "  %-20s %12s %9s %22s %9s %8s\n", "variant", "median", "speedup", "95% ci", "p", "verdict");
+        for (int32_t i = 0; i < ab->variant_count; i++) {
+            bench_io_ab_row(ab, i, "  ");
+        }
+    }
+
+    for (const fossil_bench_working_set_t *working_set = _TEST_ENV.working_sets; working_set != xnullptr; working_set = working_set->next) {
+        fossil_test_cout("blue", "benchmark working sets of %s (median with 3/4 and 2x of every cache level, line %llu bytes):\n",
+            working_set->bench.name, (unsigned long long)working_set->line_size);
+        fossil_test_cout("blue", "  %-2s %10s %12s %12s %9s\n", "", "size", "fits", "spills", "slowdown");
+        for (int32_t i = 0; i < FOSSIL_BENCH_WORKING_SET_LEVELS; i++) {
+            bench_io_working_set_level(&working_set->levels[i], "  ");
+        }
+    }
+
+    bool colds = false;
+    for (const fossil_bench_t *bench = _TEST_ENV.benches; bench != xnullptr; bench = bench->next) {
+        colds = colds || bench->cold_count > 0;
+    }
+    if (colds) {
+        char cold[32];
+        fossil_test_cout("blue", "benchmark cold vs warm (median per iteration, cold samples run one iteration on evicted caches):\n");
+        fossil_test_cout("blue", "  %-28s %11s %11s %11s %9s\n", "name", "warm", "cold", "cold mad", "slowdown");
+        for (const fossil_bench_t *bench = _TEST_ENV.benches; bench != xnullptr; bench = bench->next) {
+            if (bench->cold_count == 0) {
+                continue;
+            }
+            fossil_test_cout("cyan", "  %-28.28s %s %s %s %8.1fx\n", bench->name,
+                format_bench_time(bench->stats.median_ns, median, sizeof(median)),
+                format_bench_time(bench->cold_stats.median_ns, cold, sizeof(cold)),
+                format_bench_time(bench->cold_stats.mad_ns, mad, sizeof(mad)),
+                bench->stats.median_ns > 0.0 ? bench->cold_stats.median_ns / bench->stats.median_ns : 0.0);
+        }
+    }
+
+    bool rates = false;
+    for (const fossil_bench_t *bench = _TEST_ENV.benches; bench != xnullptr; bench = bench->next) {
+        rates = rates || bench->processed_bytes.per_iteration > 0 || bench->processed_items.per_iteration > 0;
+    }
+    if (rates) {
+        char bytes[32];
+        char items[32];
+        fossil_test_cout("blue", "benchmark throughput (median over the samples):\n");
+        fossil_test_cout("blue", "  %-28s %16s %20s\n", "name", "bytes", "items");
+        for (const fossil_bench_t *bench = _TEST_ENV.benches; bench != xnullptr; bench = bench->next) {
+            if (bench->processed_bytes.per_iteration == 0 && bench->processed_items.per_iteration == 0) {
+                continue;
+            }
+            fossil_test_cout("cyan", "  %-28.28s %16s %20s\n", bench->name,
+                bench->processed_bytes.per_iteration > 0 ? format_bench_rate(bench->processed_bytes.median, "B", bytes, sizeof(bytes)) : "-",
+                bench->processed_items.per_iteration > 0 ? format_bench_rate(bench->processed_items.median, "items", items, sizeof(items)) : "-");
+        }
+    }
+
+    if (fossil_test_allocs_available()) {
+        fossil_test_cout("blue", "benchmark allocations (per iteration):\n");
+        fossil_test_cout("blue", "  %-28s %11s %11s %13s\n", "name", "allocs", "bytes", "peak bytes");
+        for (const fossil_bench_t *bench = _TEST_ENV.benches; bench != xnullptr; bench = bench->next) {
+            double ops = bench->alloc_iterations > 0 ? (double)bench->alloc_iterations : 1.0;
+            fossil_test_cout(bench->allocs.allocs > 0 ? "yellow" : "cyan", "  %-28.28s %11.2f %11.1f %13lld\n", bench->name,
+                (double)bench->allocs.allocs / ops, (double)bench->allocs.bytes / ops, (long long)bench->allocs.peak_bytes);
+        }
+    }
+
+    bool latencies = false;
+    for (const fossil_bench_t *bench = _TEST_ENV.benches; bench != xnullptr; bench = bench->next) {
+        latencies = latencies || (bench->latency != xnullptr && bench->latency->count > 0);
+    }
+    for (const fossil_bench_scaling_t *scaling = _TEST_ENV.scalings; scaling != xnullptr; scaling = scaling->next) {
+        latencies = latencies || (scaling->bench.latency != xnullptr && scaling->bench.latency->count > 0);
+    }
+    if (latencies) {
+        fossil_test_cout("blue", "benchmark latency (per operation, within 0.8%%, scaling benchmarks on the most threads):\n");
+        fossil_test_cout("blue", "  %-28s %11s", "name", "operations");
+        for (size_t i = 0; i < sizeof(bench_latency_names) / sizeof(bench_latency_names[0]); i++) {
+            fossil_test_cout("blue", " %11s", bench_latency_names[i]);
+        }
+        fossil_test_cout("blue", " %11s\n", "max");
+        for (const fossil_bench_t *bench = _TEST_ENV.benches; bench != xnullptr; bench = bench->next) {
+            if (bench->latency != xnullptr && bench->latency->count > 0) {
+                bench_io_latency_row(bench->name, bench->latency);
+            }
+        }
+        for (const fossil_bench_scaling_t *scaling = _TEST_ENV.scalings; scaling != xnullptr; scaling = scaling->next) {
+            if (scaling->bench.latency != xnullptr && scaling->bench.latency->count > 0) {
+                bench_io_latency_row(scaling->bench.name, scaling->bench.latency);
+            }
+        }
+    }
+
+    if (_TEST_ENV.ranges != xnullptr) {
+        fossil_test_cout("blue", "benchmark complexity (best fit of the median against n):\n");
+        fossil_test_cout("blue", "  %-28s %-11s %12s %8s %19s\n", "name", "fit", "coefficient", "rms", "sizes");
+        for (const fossil_bench_range_t *range = _TEST_ENV.ranges; range != xnullptr; range = range->next) {
+            if (!range->fit.valid) {
+                fossil_test_cout("cyan", "  %-28.28s %-11s\n", range->bench.name, "-");
+                continue;
+            }
+            fossil_test_cout(range->fit.complexity == FOSSIL_BENCH_O_N_SQUARED ? "yellow" : "cyan",
+                "  %-28.28s %-11s %9.4g ns %7.1f%% %9lld..%-9lld\n", range->bench.name,
+                fossil_bench_complexity_name(range->fit.complexity), range->fit.coefficient_ns, range->fit.rms * 100.0,
+                (long long)range->points[0]->arg, (long long)range->points[range->point_count - 1]->arg);
+        }
+    }
+
+    if (_CLI.bench_compare_file[0] != '\0') {
+        fossil_test_cout("blue", "benchmark comparison against %s (threshold %.1f%%):\n", _CLI.bench_compare_file, _CLI.bench_threshold);
+        fossil_test_cout("blue", "  %-28s %11s %11s %9s %18s %9s %8s\n", "name", "baseline", "current", "delta", "95% ci", "p", "verdict");
+        for (const fossil_bench_t *bench = _TEST_ENV.benches; bench != xnullptr; bench = bench->next) {
+            bench_io_compare_row(bench->name, bench->compare.verdict != FOSSIL_BENCH_VERDICT_NONE, bench->compare.baseline_median_ns,
+                true, bench->stats.median_ns, &bench->compare);
+        }
+    }
+
+    if (!_CLI.counters_enabled) {
+        return;
+    }
+    char line[256];
+    fossil_test_cout("blue", "benchmark counters (per iteration):\n");
+    for (const fossil_bench_t *bench = _TEST_ENV.benches; bench != xnullptr; bench = bench->next) {
+        counters_format(line, sizeof(line), &bench->counters, bench->counted_iterations);
+        fossil_test_cout("cyan", "  %-28.28s %s\n", bench->name, line[0] != '\0' ? line : "not counted");
+    }
+}
+
+// Copies the value of one key of a host line, empty when it is missing
+static void host_value(const char *host, const char *key, char *out, size_t size) {
+    size_t length = strlen(key);
+    out[0] = '\0';
+    for (const char *at = strstr(host, key); at != xnullptr; at = strstr(at + 1, key)) {
+        if ((at == host || at[-1] == ' ') && at[length] == ' ') {
+            at += length + 1;
+            snprintf(out, size, "%.*s", (int)strcspn(at, " "), at);
+            return;
+        }
+    }
+}
+
+// Writes a string as a JSON string literal
+static void json_string(FILE *out, const char *text) {
+    fputc('"', out);
+    for (; *text != '\0'; text++) {
+        if (*text == '"' || *text == '\\') {
+            fprintf(out, "\\%c", *text);
+        } else if ((unsigned char)*text < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned)(unsigned char)*text);
+        } else {
+            fputc(*text, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void bench_report_json(const char *old_path, const char *old_host, const char *new_path, const char *new_host,
+    const fossil_bench_report_row_t *rows, int32_t count) {
+    FILE *out = console_stream();
+    fprintf(out, "{\n  \"old\": {\"file\": ");
+    json_string(out, old_path);
+    fprintf(out, ", \"host\": ");
+    json_string(out, old_host);
+    fprintf(out, "},\n  \"new\": {\"file\": ");
+    json_string(out, new_path);
+    fprintf(out, ", \"host\": ");
+    json_string(out, new_host);
+    fprintf(out, "},\n  \"threshold_percent\": %.6g,\n  \"benchmarks\": [", _CLI.bench_threshold);
+    for (int32_t i = 0; i < count; i++) {
+        const fossil_bench_report_row_t *row = &rows[i];
+        fprintf(out, "%s\n    {\"name\": ", i > 0 ? "," : "");
+        json_string(out, row->name);
+        if (row->before != xnullptr) {
+            fprintf(out, ", \"old_median_ns\": %.6g, \"old_samples\": %d", row->before_median_ns, row->before->sample_count);
+        }
+        if (row->after != xnullptr) {
+            fprintf(out, ", \"new_median_ns\": %.6g, \"new_samples\": %d", row->after_median_ns, row->after->sample_count);
+        }
+        if (row->before != xnullptr && row->after != xnullptr) {
+            fprintf(out, ", \"delta\": %.6g, \"delta_low\": %.6g, \"delta_high\": %.6g, \"p_value\": %.6g",
+                row->compare.delta, row->compare.delta_low, row->compare.delta_high, row->compare.p_value);
+        }
+        fprintf(out, ", \"verdict\": \"%s\"}", row->after == xnullptr ? "removed" : bench_verdict_name(row->compare.verdict));
+    }
+    fprintf(out, "%s]\n}\n", count > 0 ? "\n  " : "");
+}
+
+void fossil_test_io_bench_report(const char *old_path, const char *old_host, const char *new_path, const char *new_host,
+    const fossil_bench_report_row_t *rows, int32_t count, bool json) {
+    static const char *const host_keys[] = { "cpu", "cpus", "kernel" };
+    if (json) {
+        bench_report_json(old_path, old_host, new_path, new_host, rows, count);
+        return;
+    }
+    fossil_test_cout("blue", "=============================================================================================\n");
+    fossil_test_cout("blue", "benchmark comparison of %s against %s (threshold %.1f%%):\n", new_path, old_path, _CLI.bench_threshold);
+    fossil_test_cout("cyan", "  old host: %s\n", old_host[0] != '\0' ? old_host : "unknown");
+    fossil_test_cout("cyan", "  new host: %s\n", new_host[0] != '\0' ? new_host : "unknown");
+    for (size_t i = 0; i < sizeof(host_keys) / sizeof(host_keys[0]); i++) {
+        char before[128];
+        char after[128];
+        host_value(old_host, host_keys[i], before, sizeof(before));
+        host_value(new_host, host_keys[i], after, sizeof(after));
+        if (strcmp(before, after) != 0) {
+            fossil_test_cout("yellow", "[host] the runs differ in %s (%s, %s), the comparison may not be meaningful\n",
+                host_keys[i], before[0] != '\0' ? before : "unknown", after[0] != '\0' ? after : "unknown");
+        }
+    }
+    fossil_test_cout("blue", "  %-28s %11s %11s %9s %18s %9s %8s\n", "name", "old", "new", "delta", "95% ci", "p", "verdict");
+    for (int32_t i = 0; i < count; i++) {
+        bench_io_compare_row(rows[i].name, rows[i].before != xnullptr, rows[i].before_median_ns,
+            rows[i].after != xnullptr, rows[i].after_median_ns, &rows[i].compare);
+    }
     fossil_test_cout("blue", "=============================================================================================\n");
 }
 
@@ -481,6 +1710,12 @@ void fossil_test_io_summary_ended(void) {
     fossil_test_cout("blue", "=============================================================================================\n");
     fossil_test_cout("blue", "Total Tests: %d\n", _TEST_ENV.stats.expected_total_count);
     fossil_test_cout("blue", "Total Ghost: %d\n", _TEST_ENV.stats.untested_count);
+    if (_CLI.slowest_enabled) {
+        fossil_test_io_timings(_TEST_ENV.timings, _TEST_ENV.timing_count);
+    }
+    if (_TEST_ENV.benches != xnullptr || _TEST_ENV.scalings != xnullptr) {
+        fossil_test_io_summary_benches();
+    }
     fossil_test_cout("blue", "=============================================================================================\n");
     calculate_elapsed_time(&_TEST_ENV.timer);
     fossil_test_cout("yellow", "timestamp : -> %ld minutes, %ld seconds, %ld milliseconds, %ld microseconds, %ld nanoseconds\n",
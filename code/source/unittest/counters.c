@@ -0,0 +1,184 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/unittest/counters.h"
+#include "fossil/unittest/console.h"
+#if defined(__linux__)
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+// ==============================================================================
+// Xmark hardware counters
+// ==============================================================================
+
+static const char *counter_names[FOSSIL_BENCH_COUNTER_COUNT] = {
+    "cycles", "instructions", "l1d-misses", "llc-misses", "branch-misses", "ctx-switches"
+};
+
+const char *fossil_bench_counters_name(fossil_bench_counter_t counter) {
+    if (counter < 0 || counter >= FOSSIL_BENCH_COUNTER_COUNT) {
+        return "unknown";
+    }
+    return counter_names[counter];
+}
+
+void fossil_bench_counters_accumulate(fossil_bench_counters_t *total, const fossil_bench_counters_t *begin, const fossil_bench_counters_t *end) {
+    for (int32_t i = 0; i < FOSSIL_BENCH_COUNTER_COUNT; i++) {
+        if (begin->valid[i] && end->valid[i]) {
+            total->valid[i] = true;
+            total->value[i] += end->value[i] >= begin->value[i] ? end->value[i] - begin->value[i] : 0;
+        }
+    }
+}
+
+#if defined(__linux__)
+
+// One group per thread: the first event that opens leads, the rest follow it
+static _Thread_local struct {
+    bool tried;                                  // open was attempted on this thread
+    int leader;                                  // group leader fd, -1 when closed
+    int fds[FOSSIL_BENCH_COUNTER_COUNT];         // fd per event, -1 when not counted
+    fossil_bench_counter_t order[FOSSIL_BENCH_COUNTER_COUNT]; // events in group read order
+    int32_t members;                             // events in the group
+} group = { false, -1, {-1, -1, -1, -1, -1, -1}, {FOSSIL_BENCH_COUNTER_CYCLES}, 0 };
+
+static bool unavailable_reported = false;
+
+static void counter_attr(fossil_bench_counter_t counter, struct perf_event_attr *attr) {
+    memset(attr, 0, sizeof(*attr));
+    attr->size = sizeof(*attr);
+    attr->type = PERF_TYPE_HARDWARE;
+    switch (counter) {
+        case FOSSIL_BENCH_COUNTER_CYCLES:
+            attr->config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case FOSSIL_BENCH_COUNTER_INSTRUCTIONS:
+            attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case FOSSIL_BENCH_COUNTER_L1D_MISSES:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = PERF_COUNT_HW_CACHE_L1D |
+                           (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case FOSSIL_BENCH_COUNTER_LLC_MISSES:
+            attr->config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case FOSSIL_BENCH_COUNTER_BRANCH_MISSES:
+            attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        default:
+            attr->type = PERF_TYPE_SOFTWARE;
+            attr->config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+            break;
+    }
+    attr->read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // allowed with the default perf_event_paranoid of 2, but the kernel does
+    // every context switch, so that event reads 0 unless kernel mode counts.
+    // When the host refuses it, it is left out of the group as not counted.
+    attr->exclude_kernel = attr->type == PERF_TYPE_SOFTWARE ? 0 : 1;
+    attr->exclude_hv = 1;
+    attr->disabled = 1;
+}
+
+bool fossil_bench_counters_open(void) {
+    if (group.tried) {
+        return group.leader >= 0;
+    }
+    group.tried = true;
+
+    int first_error = 0;
+    for (int32_t i = 0; i < FOSSIL_BENCH_COUNTER_COUNT; i++) {
+        struct perf_event_attr attr;
+        counter_attr((fossil_bench_counter_t)i, &attr);
+        int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, group.leader, 0);
+        if (fd < 0) {
+            if (first_error == 0) {
+                first_error = errno;
+            }
+            continue; // the group is built from whatever this host can count
+        }
+        if (group.leader < 0) {
+            group.leader = fd;
+        }
+        group.fds[i] = fd;
+        group.order[group.members++] = (fossil_bench_counter_t)i;
+    }
+
+    if (group.leader < 0) {
+        if (!unavailable_reported) {
+            fossil_test_cout("yellow", "perf counters unavailable (%s), reporting wall time only\n", strerror(first_error));
+            unavailable_reported = true;
+        }
+        return false;
+    }
+
+    ioctl(group.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(group.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void fossil_bench_counters_close(void) {
+    for (int32_t i = 0; i < FOSSIL_BENCH_COUNTER_COUNT; i++) {
+        if (group.fds[i] >= 0) {
+            close(group.fds[i]);
+            group.fds[i] = -1;
+        }
+    }
+    group.leader = -1;
+    group.members = 0;
+    group.tried = false;
+}
+
+bool fossil_bench_counters_read(fossil_bench_counters_t *reading) {
+    memset(reading, 0, sizeof(*reading));
+    if (group.leader < 0) {
+        return false;
+    }
+
+    // nr, time enabled, time running, then one value per member
+    uint64_t buffer[3 + FOSSIL_BENCH_COUNTER_COUNT];
+    ssize_t got = read(group.leader, buffer, sizeof(buffer));
+    if (got < (ssize_t)(3 * sizeof(uint64_t)) || buffer[2] == 0) {
+        return false;
+    }
+
+    // scale up when the kernel had to multiplex the group
+    double scale = buffer[2] < buffer[1] ? (double)buffer[1] / (double)buffer[2] : 1.0;
+    int32_t count = (int32_t)buffer[0] < group.members ? (int32_t)buffer[0] : group.members;
+    for (int32_t i = 0; i < count; i++) {
+        fossil_bench_counter_t counter = group.order[i];
+        reading->valid[counter] = true;
+        reading->value[counter] = (uint64_t)((double)buffer[3 + i] * scale);
+    }
+    return true;
+}
+
+#else
+
+bool fossil_bench_counters_open(void) {
+    return false;
+}
+
+void fossil_bench_counters_close(void) {
+    // nothing was opened
+}
+
+bool fossil_bench_counters_read(fossil_bench_counters_t *reading) {
+    memset(reading, 0, sizeof(*reading));
+    return false;
+}
+
+#endif
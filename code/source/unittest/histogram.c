@@ -0,0 +1,113 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/unittest/histogram.h"
+#include "fossil/unittest/benchmark.h"
+#include "fossil/unittest/scaling.h"
+#include <math.h>
+
+// ==============================================================================
+// Xmark functions for latency histograms
+// ==============================================================================
+
+// Highest value that falls into the bucket
+static uint64_t histogram_bucket_high(int32_t index) {
+    const int32_t half = 1 << (FOSSIL_BENCH_HISTOGRAM_SUB_BITS - 1);
+    if (index < 2 * half) {
+        return (uint64_t)index;
+    }
+    int32_t shift = index / half - 1;
+    uint64_t step = (uint64_t)(index - shift * half);
+    return ((step + 1) << shift) - 1;
+}
+
+void fossil_bench_histogram_reset(fossil_bench_histogram_t *histogram) {
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+void fossil_bench_histogram_merge(fossil_bench_histogram_t *into, const fossil_bench_histogram_t *from) {
+    if (from->count == 0) {
+        return;
+    }
+    for (int32_t i = 0; i < FOSSIL_BENCH_HISTOGRAM_COUNTS; i++) {
+        into->counts[i] += from->counts[i];
+    }
+    into->min = into->count == 0 || from->min < into->min ? from->min : into->min;
+    into->max = from->max > into->max ? from->max : into->max;
+    into->sum += from->sum;
+    into->count += from->count;
+}
+
+uint64_t fossil_bench_histogram_percentile(const fossil_bench_histogram_t *histogram, double percentile) {
+    if (histogram->count == 0) {
+        return 0;
+    }
+    if (percentile <= 0.0) {
+        return histogram->min;
+    }
+    double rank = ceil(percentile / 100.0 * (double)histogram->count);
+    uint64_t wanted = rank < 1.0 ? 1 : (uint64_t)rank;
+    uint64_t seen = 0;
+    for (int32_t i = 0; i < FOSSIL_BENCH_HISTOGRAM_COUNTS; i++) {
+        seen += histogram->counts[i];
+        if (seen >= wanted) {
+            uint64_t value = histogram_bucket_high(i);
+            value = value > histogram->max ? histogram->max : value;
+            return value < histogram->min ? histogram->min : value;
+        }
+    }
+    return histogram->max;
+}
+
+void fossil_bench_histogram_export(const fossil_bench_histogram_t *histogram, const char *name, FILE *file) {
+    fprintf(file, "# %s, latency per operation in nanoseconds\n", name);
+    fprintf(file, "%12s %14s %10s %14s\n\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+    uint64_t seen = 0;
+    for (int32_t i = 0; i < FOSSIL_BENCH_HISTOGRAM_COUNTS && seen < histogram->count; i++) {
+        if (histogram->counts[i] == 0) {
+            continue;
+        }
+        seen += histogram->counts[i];
+        uint64_t value = histogram_bucket_high(i);
+        value = value > histogram->max ? histogram->max : value;
+        double fraction = (double)seen / (double)histogram->count;
+        if (seen < histogram->count) {
+            fprintf(file, "%12.3f %14.12f %10llu %14.2f\n", (double)value, fraction, (unsigned long long)seen, 1.0 / (1.0 - fraction));
+        } else {
+            fprintf(file, "%12.3f %14.12f %10llu\n", (double)value, fraction, (unsigned long long)seen);
+        }
+    }
+    double mean = histogram->count > 0 ? histogram->sum / (double)histogram->count : 0.0;
+    fprintf(file, "#[Mean    = %12.3f, Min            = %12llu]\n", mean, (unsigned long long)histogram->min);
+    fprintf(file, "#[Max     = %12llu, Total count    = %12llu]\n\n", (unsigned long long)histogram->max,
+        (unsigned long long)histogram->count);
+}
+
+bool fossil_bench_latency_save(const char *path, const fossil_bench_t *benches, const fossil_bench_scaling_t *scalings) {
+    FILE *file = fopen(path, "w");
+    if (file == xnullptr) {
+        return false;
+    }
+    for (const fossil_bench_t *bench = benches; bench != xnullptr; bench = bench->next) {
+        if (bench->latency != xnullptr) {
+            fossil_bench_histogram_export(bench->latency, bench->name, file);
+        }
+    }
+    for (const fossil_bench_scaling_t *scaling = scalings; scaling != xnullptr; scaling = scaling->next) {
+        if (scaling->bench.latency != xnullptr && scaling->point_count > 0) {
+            char name[160];
+            snprintf(name, sizeof(name), "%s on %d threads", scaling->bench.name, scaling->points[scaling->point_count - 1].threads);
+            fossil_bench_histogram_export(scaling->bench.latency, name, file);
+        }
+    }
+    return fclose(file) == 0;
+}
@@ -0,0 +1,140 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/unittest/host.h"
+#include "fossil/unittest/console.h"
+#include "fossil/unittest/commands.h"
+#include "fossil/_common/platform.h"
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/resource.h>
+#endif
+
+// ==============================================================================
+// Xmark functions for benchmark noise control
+// ==============================================================================
+
+//
+// local types
+//
+
+static bool host_prepared = false;
+#if defined(__linux__)
+static cpu_set_t host_affinity; // affinity of the process before pinning
+static bool host_pinned = false;
+#endif
+
+// Pins the calling thread to one CPU
+static bool host_pin(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(host_affinity), &host_affinity) != 0) {
+        return false;
+    }
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    host_pinned = sched_setaffinity(0, sizeof(set), &set) == 0;
+    return host_pinned;
+#elif defined(_WIN32)
+    return cpu < (int)(sizeof(DWORD_PTR) * 8) && SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Raises the scheduling priority of the calling thread
+static bool host_raise_priority(void) {
+#if defined(__linux__)
+    return setpriority(PRIO_PROCESS, 0, -10) == 0;
+#elif defined(_WIN32)
+    return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST) != 0;
+#else
+    return false;
+#endif
+}
+
+void fossil_bench_host_prepare(void) {
+    if (host_prepared) {
+        return;
+    }
+    host_prepared = true;
+
+    int cpu = _CLI.bench_cpu;
+    if (cpu >= 0 && !host_pin(cpu)) {
+        fossil_test_cout("yellow", "[host] could not pin benchmarks to cpu %d, running unpinned\n", cpu);
+        cpu = -1;
+    }
+    if (_CLI.bench_priority && !host_raise_priority()) {
+        fossil_test_cout("yellow", "[host] could not raise the scheduling priority, it needs extra privileges\n");
+    }
+
+    const char *governor = _fossil_test_get_cpu_governor();
+    if (governor[0] != '\0' && strcmp(governor, "performance") != 0) {
+        fossil_test_cout("yellow", "[host] cpufreq governor is \"%s\", set it to \"performance\" for stable timings\n", governor);
+    }
+    if (_fossil_test_get_turbo() == 1) {
+        fossil_test_cout("yellow", "[host] turbo boost is on, timings follow temperature and load\n");
+    }
+    char siblings[64];
+    if (cpu >= 0 && _fossil_test_get_cpu_siblings(cpu, siblings, sizeof(siblings)) && strchr(siblings, ',') != xnullptr) {
+        fossil_test_cout("yellow", "[host] cpu %d shares its core with cpus %s, keep them idle\n", cpu, siblings);
+    } else if (cpu < 0 && _fossil_test_get_smt() == 1) {
+        fossil_test_cout("yellow", "[host] SMT is active, sibling threads share a core with the benchmark\n");
+    }
+}
+
+void fossil_bench_host_release(void) {
+#if defined(__linux__)
+    if (host_pinned) {
+        sched_setaffinity(0, sizeof(host_affinity), &host_affinity);
+    }
+#endif
+}
+
+// Appends " key value" to out, whitespace inside the value becomes '_'
+static size_t host_token(char *out, size_t size, size_t used, const char *key, const char *value) {
+    int written = snprintf(out + used, size - used, " %s ", key);
+    if (written < 0 || used + (size_t)written >= size) {
+        return used;
+    }
+    used += (size_t)written;
+    for (; *value != '\0' && used + 1 < size; value++) {
+        out[used++] = isspace((unsigned char)*value) ? '_' : *value;
+    }
+    out[used] = '\0';
+    return used;
+}
+
+void fossil_bench_host_describe(char *out, size_t size) {
+    char number[64];
+    double load[3] = {0.0, 0.0, 0.0};
+    size_t used = 0;
+    out[0] = '\0';
+    used = host_token(out, size, used, "cpu", _fossil_test_get_cpu_model());
+    snprintf(number, sizeof(number), "%d", _fossil_test_get_cpu_mhz());
+    used = host_token(out, size, used, "mhz", number);
+    snprintf(number, sizeof(number), "%d", _fossil_test_get_num_cpus());
+    used = host_token(out, size, used, "cpus", number);
+    used = host_token(out, size, used, "os", _fossil_test_get_os_name());
+    used = host_token(out, size, used, "kernel", _fossil_test_get_kernel());
+    if (_fossil_test_get_load_average(load)) {
+        snprintf(number, sizeof(number), "%.2f/%.2f/%.2f", load[0], load[1], load[2]);
+        used = host_token(out, size, used, "load", number);
+    }
+    const char *governor = _fossil_test_get_cpu_governor();
+    if (governor[0] != '\0') {
+        used = host_token(out, size, used, "governor", governor);
+    }
+    snprintf(number, sizeof(number), "%d", _CLI.bench_cpu);
+    host_token(out, size, used, "pinned", number);
+}
@@ -0,0 +1,278 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/unittest/scaling.h"
+#include "fossil/unittest/console.h"
+#include "fossil/unittest/commands.h"
+#include "fossil/unittest/host.h"
+#include "fossil/_common/platform.h"
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// ==============================================================================
+// Xmark functions for thread scaling benchmarks
+// ==============================================================================
+
+//
+// local types
+//
+
+enum {
+    SCALING_MAX_THREADS = 256 // guard for bench-threads and very large hosts
+};
+
+// One shot barrier, every thread of a round waits until all have arrived
+typedef struct {
+#ifdef _WIN32
+    SRWLOCK lock;
+    CONDITION_VARIABLE opened;
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t opened;
+#endif
+    int32_t arrived;
+    int32_t expected;
+} scaling_barrier_t;
+
+// Copy of the benchmark handed to one thread of a round
+typedef struct {
+    fossil_bench_t bench;
+    scaling_barrier_t *barrier;
+    uint64_t elapsed_ns;
+} scaling_worker_t;
+
+#ifdef _WIN32
+typedef HANDLE scaling_thread_t;
+#else
+typedef pthread_t scaling_thread_t;
+#endif
+
+static void scaling_barrier_init(scaling_barrier_t *barrier, int32_t expected) {
+#ifdef _WIN32
+    InitializeSRWLock(&barrier->lock);
+    InitializeConditionVariable(&barrier->opened);
+#else
+    pthread_mutex_init(&barrier->lock, xnullptr);
+    pthread_cond_init(&barrier->opened, xnullptr);
+#endif
+    barrier->arrived = 0;
+    barrier->expected = expected;
+}
+
+static void scaling_barrier_destroy(scaling_barrier_t *barrier) {
+#ifndef _WIN32
+    pthread_cond_destroy(&barrier->opened);
+    pthread_mutex_destroy(&barrier->lock);
+#else
+    (void)barrier;
+#endif
+}
+
+// Arrives at the barrier, or only lowers the count when expected is given
+static void scaling_barrier_wait(scaling_barrier_t *barrier, int32_t expected) {
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&barrier->lock);
+#else
+    pthread_mutex_lock(&barrier->lock);
+#endif
+    if (expected > 0) {
+        barrier->expected = expected; // some threads could not be started
+    } else {
+        barrier->arrived++;
+    }
+    if (barrier->arrived >= barrier->expected) {
+#ifdef _WIN32
+        WakeAllConditionVariable(&barrier->opened);
+#else
+        pthread_cond_broadcast(&barrier->opened);
+#endif
+    }
+    while (expected == 0 && barrier->arrived < barrier->expected) {
+#ifdef _WIN32
+        SleepConditionVariableSRW(&barrier->opened, &barrier->lock, INFINITE, 0);
+#else
+        pthread_cond_wait(&barrier->opened, &barrier->lock);
+#endif
+    }
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&barrier->lock);
+#else
+    pthread_mutex_unlock(&barrier->lock);
+#endif
+}
+
+static void scaling_work(scaling_worker_t *worker) {
+    scaling_barrier_wait(worker->barrier, 0);
+    worker->elapsed_ns = fossil_bench_sample(&worker->bench);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI scaling_thread(LPVOID arg) {
+    scaling_work((scaling_worker_t*)arg);
+    return 0;
+}
+#else
+static void *scaling_thread(void *arg) {
+    fossil_bench_host_release(); // threads inherit the pinned affinity
+    scaling_work((scaling_worker_t*)arg);
+    return xnullptr;
+}
+#endif
+
+static bool scaling_thread_start(scaling_thread_t *thread, scaling_worker_t *worker) {
+#ifdef _WIN32
+    *thread = CreateThread(xnullptr, 0, scaling_thread, worker, 0, xnullptr);
+    return *thread != xnullptr;
+#else
+    return pthread_create(thread, xnullptr, scaling_thread, worker) == 0;
+#endif
+}
+
+static void scaling_thread_join(scaling_thread_t thread) {
+#ifdef _WIN32
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, xnullptr);
+#endif
+}
+
+// Runs one round on the given number of threads, the caller is thread 0.
+// Returns the number of threads that actually ran.
+static int32_t scaling_round(const fossil_bench_t *bench, scaling_worker_t *workers, scaling_thread_t *threads,
+    fossil_bench_histogram_t *histograms, int32_t count) {
+    scaling_barrier_t barrier;
+    scaling_barrier_init(&barrier, count);
+    for (int32_t i = 0; i < count; i++) {
+        workers[i].bench = *bench;
+        workers[i].bench.latency = histograms != xnullptr ? &histograms[i] : xnullptr;
+        workers[i].bench.thread_index = i;
+        workers[i].bench.thread_count = count;
+        workers[i].barrier = &barrier;
+        workers[i].elapsed_ns = 0;
+    }
+
+    int32_t started = 1;
+    while (started < count && scaling_thread_start(&threads[started], &workers[started])) {
+        started++;
+    }
+    if (started < count) {
+        scaling_barrier_wait(&barrier, started);
+    }
+    scaling_work(&workers[0]);
+    for (int32_t i = 1; i < started; i++) {
+        scaling_thread_join(threads[i]);
+    }
+    scaling_barrier_destroy(&barrier);
+    return started;
+}
+
+// Adds the scaling benchmark to the results of this run, once
+static void scaling_record(fossil_bench_scaling_t *scaling) {
+    fossil_bench_scaling_t **link = &_TEST_ENV.scalings;
+    while (*link != xnullptr) {
+        if (*link == scaling) {
+            return;
+        }
+        link = &(*link)->next;
+    }
+    scaling->next = xnullptr;
+    *link = scaling;
+}
+
+void fossil_bench_run_threads(fossil_bench_scaling_t *scaling, const char *name, fossil_bench_function_t function) {
+    if (scaling == xnullptr || function == xnullptr) {
+        return;
+    }
+    fossil_bench_t *bench = &scaling->bench;
+    memset(bench, 0, sizeof(*bench));
+    bench->name = name;
+    bench->function = function;
+    bench->thread_count = 1;
+    bench->alloc_limit = -1.0;
+    fossil_bench_calibrate(bench, FOSSIL_BENCH_SCALING_ROUND_NS);
+
+    int32_t limit = _CLI.bench_threads > 0 ? _CLI.bench_threads : _fossil_test_get_num_cpus();
+    if (limit < 1) {
+        limit = 1;
+    } else if (limit > SCALING_MAX_THREADS) {
+        limit = SCALING_MAX_THREADS;
+    }
+    scaling_worker_t *workers = (scaling_worker_t*)malloc((size_t)limit * sizeof(scaling_worker_t));
+    scaling_thread_t *threads = (scaling_thread_t*)malloc((size_t)limit * sizeof(scaling_thread_t));
+    if (workers == xnullptr || threads == xnullptr) {
+        free(workers);
+        free(threads);
+        return;
+    }
+
+    // one histogram per thread, merged after every round
+    fossil_bench_histogram_t *histograms = xnullptr;
+    bench->latency = fossil_bench_latency_create(bench);
+    if (bench->latency != xnullptr) {
+        histograms = (fossil_bench_histogram_t*)calloc((size_t)limit, sizeof(fossil_bench_histogram_t));
+        bench->latency = histograms != xnullptr ? bench->latency : xnullptr;
+    }
+
+    scaling->point_count = 0;
+    for (int32_t count = 1; scaling->point_count < FOSSIL_BENCH_SCALING_POINTS; count *= 2) {
+        if (count > limit) {
+            count = limit; // the last step lands on the limit itself
+        }
+        double ops[FOSSIL_BENCH_SCALING_ROUNDS];
+        double latency[FOSSIL_BENCH_SCALING_ROUNDS];
+        int32_t started = count;
+        if (bench->latency != xnullptr) {
+            fossil_bench_histogram_reset(bench->latency);
+        }
+        for (int32_t round = 0; round < FOSSIL_BENCH_SCALING_ROUNDS && started == count; round++) {
+            started = scaling_round(bench, workers, threads, histograms, count);
+            uint64_t wall = 0;
+            uint64_t total = 0;
+            for (int32_t i = 0; i < started; i++) {
+                wall = workers[i].elapsed_ns > wall ? workers[i].elapsed_ns : wall;
+                total += workers[i].elapsed_ns;
+                if (histograms != xnullptr) {
+                    fossil_bench_histogram_merge(bench->latency, &histograms[i]);
+                    fossil_bench_histogram_reset(&histograms[i]);
+                }
+            }
+            ops[round] = wall > 0 ? (double)started * (double)bench->iterations * 1e9 / (double)wall : 0.0;
+            latency[round] = (double)total / (double)started / (double)bench->iterations;
+        }
+        if (started < count) {
+            fossil_test_cout("yellow", "could only start %d of %d threads for %s, scaling stops here\n", started, count, name);
+            break;
+        }
+
+        fossil_bench_stats_t stats;
+        fossil_bench_scaling_point_t *point = &scaling->points[scaling->point_count++];
+        point->threads = count;
+        fossil_bench_stats(ops, FOSSIL_BENCH_SCALING_ROUNDS, &stats);
+        point->ops_per_second = stats.median_ns;
+        fossil_bench_stats(latency, FOSSIL_BENCH_SCALING_ROUNDS, &stats);
+        point->latency_ns = stats.median_ns;
+        double single = scaling->points[0].ops_per_second;
+        point->efficiency = single > 0.0 ? point->ops_per_second / ((double)count * single) : 0.0;
+        point->p99_ns = bench->latency != xnullptr ? (double)fossil_bench_histogram_percentile(bench->latency, 99.0) : 0.0;
+        if (count == limit) {
+            break;
+        }
+    }
+    free(workers);
+    free(threads);
+    free(histograms);
+
+    scaling_record(scaling);
+    fossil_test_io_bench_scaling(scaling);
+}
@@ -0,0 +1,272 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/unittest/startup.h"
+#include "fossil/unittest/internal.h"
+#include "fossil/_common/platform.h"
+#include <stdarg.h>
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/wait.h>
+#endif
+
+// ==============================================================================
+// Xmark functions for process startup benchmarks
+// ==============================================================================
+
+enum {
+    STARTUP_MARKER_MAX = 256,      // longest readiness marker
+    STARTUP_READ_CHUNK = 4096,     // bytes read from the child at once
+    STARTUP_TIMEOUT_MS = 30000,    // longest a start may take before it is killed
+    STARTUP_REAP_POLL_NS = 20000   // wait between checks for the exit after the output ended
+};
+
+// What the running startup benchmark starts, benchmarks run one at a time
+static fossil_bench_t *startup_bench = xnullptr;
+static const char *const *startup_argv = xnullptr;
+static const char *startup_marker = xnullptr;
+static fossil_bench_entry_t startup_entry = xnullptr;
+static char startup_error[STARTUP_MARKER_MAX + 128];
+
+// Write end of the readiness pipe, only open in a child of an entry benchmark
+static int startup_ready_fd = -1;
+
+// Only the first problem is reported, every later start would repeat it
+static void startup_fail(const char *format, ...) {
+    if (startup_error[0] != '\0') {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vsnprintf(startup_error, sizeof(startup_error), format, args);
+    va_end(args);
+}
+
+#ifndef _WIN32
+
+void fossil_bench_startup_ready(void) {
+    if (startup_ready_fd < 0) {
+        return;
+    }
+    ssize_t written;
+    do {
+        written = write(startup_ready_fd, "\n", 1);
+    } while (written < 0 && errno == EINTR);
+    close(startup_ready_fd);
+    startup_ready_fd = -1;
+}
+
+static bool startup_find(const char *data, size_t size, const char *marker, size_t length) {
+    for (size_t at = 0; at + length <= size; at++) {
+        if (memcmp(data + at, marker, length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+typedef enum {
+    STARTUP_READY,   // the marker showed up
+    STARTUP_ENDED,   // the child closed its end
+    STARTUP_TIMEOUT  // neither before the deadline
+} startup_watch_t;
+
+static int startup_remaining_ms(uint64_t deadline) {
+    uint64_t now = fossil_test_clock_ns();
+    return now >= deadline ? 0 : (int)((deadline - now + 999999) / 1000000);
+}
+
+// Reads what the child writes until the marker shows up, or until the end
+// when there is no marker, giving up at the deadline.
+static startup_watch_t startup_watch(int fd, const char *marker, uint64_t deadline) {
+    char window[STARTUP_MARKER_MAX + STARTUP_READ_CHUNK];
+    size_t length = marker != xnullptr ? strlen(marker) : 0;
+    size_t kept = 0;
+    for (;;) {
+        struct pollfd watched = { fd, POLLIN, 0 };
+        int polled = poll(&watched, 1, startup_remaining_ms(deadline));
+        if (polled < 0 && errno == EINTR) {
+            continue;
+        }
+        if (polled == 0) {
+            return STARTUP_TIMEOUT;
+        }
+        ssize_t got = polled < 0 ? -1 : read(fd, window + kept, STARTUP_READ_CHUNK);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return STARTUP_ENDED;
+        }
+        size_t size = kept + (size_t)got;
+        if (length > 0 && startup_find(window, size, marker, length)) {
+            return STARTUP_READY;
+        }
+        // the end of what was read may hold the start of the marker
+        kept = length > 1 ? (size < length - 1 ? size : length - 1) : 0;
+        memmove(window, window + size - kept, kept);
+    }
+}
+
+// Waits for the child to exit, false when it is still running at the deadline.
+// Its output has ended by now, so this is normally over at once. The child is
+// left a zombie, its pid and so its process group stay taken until reaped.
+static bool startup_exited(pid_t child, uint64_t deadline) {
+    for (;;) {
+        siginfo_t info;
+        info.si_pid = 0;
+        if (waitid(P_PID, (id_t)child, &info, WEXITED | WNOHANG | WNOWAIT) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return true;
+        }
+        if (info.si_pid == child) {
+            return true;
+        }
+        if (startup_remaining_ms(deadline) == 0) {
+            return false;
+        }
+        struct timespec nap = { 0, STARTUP_REAP_POLL_NS };
+        nanosleep(&nap, xnullptr);
+    }
+}
+
+// Kills the child and everything it started, they share its process group,
+// then reaps the child. Returns its wait status.
+static int startup_kill(pid_t child) {
+    int status = 0;
+    kill(-child, SIGKILL);
+    while (waitpid(child, &status, 0) < 0 && errno == EINTR) {
+        // interrupted, wait again
+    }
+    return status;
+}
+
+// Runs in the child, never returns
+static void startup_child(int fds[2]) {
+    setpgid(0, 0);
+    close(fds[0]);
+    if (startup_entry != xnullptr) {
+        startup_ready_fd = fds[1];
+        int code = startup_entry();
+        fflush(xnull);
+        _exit(code);
+    }
+    dup2(fds[1], STDOUT_FILENO);
+    close(fds[1]);
+    execvp(startup_argv[0], (char *const*)startup_argv);
+    _exit(127);
+}
+
+// One start of the child, the sample of the benchmark is timed around it
+static void startup_sample(void) {
+    if (startup_error[0] != '\0') {
+        return; // every later start would fail the same way, or hang as long
+    }
+    const char *what = startup_entry != xnullptr ? startup_bench->name : startup_argv[0];
+    int fds[2];
+    if (pipe(fds) != 0) {
+        startup_fail("could not create a pipe for %s (errno %d)", what, errno);
+        return;
+    }
+    fflush(xnull); // buffered output would be written by the child as well
+    uint64_t deadline = fossil_test_clock_ns() + (uint64_t)STARTUP_TIMEOUT_MS * 1000000;
+    pid_t child = fork();
+    if (child == 0) {
+        startup_child(fds);
+    }
+    close(fds[1]);
+    if (child < 0) {
+        close(fds[0]);
+        startup_fail("could not fork to start %s (errno %d)", what, errno);
+        return;
+    }
+    setpgid(child, child); // as the child does, whichever runs first
+
+    startup_watch_t watched = startup_watch(fds[0], startup_entry != xnullptr ? "\n" : startup_marker, deadline);
+    bool exited = watched == STARTUP_ENDED && startup_exited(child, deadline);
+    // the child may still be running or have left children behind, stopping
+    // them is left out of the sample
+    fossil_bench_pause(startup_bench);
+    int status = startup_kill(child);
+    close(fds[0]);
+    fossil_bench_resume(startup_bench);
+
+    if (watched == STARTUP_READY) {
+        return;
+    }
+    if (!exited) {
+        startup_fail(startup_marker != xnullptr || startup_entry != xnullptr ?
+            "%s was neither ready nor done after %d ms, it was killed" : "%s was not done after %d ms, it was killed",
+            what, STARTUP_TIMEOUT_MS);
+    } else if (WIFSIGNALED(status)) {
+        startup_fail("%s was killed by signal %d", what, WTERMSIG(status));
+    } else if (startup_entry == xnullptr && WEXITSTATUS(status) == 127) {
+        startup_fail("could not exec %s", what);
+    } else if (WEXITSTATUS(status) != 0) {
+        startup_fail("%s exited with status %d", what, WEXITSTATUS(status));
+    } else if (startup_marker != xnullptr && startup_entry == xnullptr) {
+        startup_fail("%s exited without writing \"%s\"", what, startup_marker);
+    }
+}
+
+#else
+
+void fossil_bench_startup_ready(void) {
+    // there are no children on Windows
+}
+
+static void startup_sample(void) {
+    startup_fail("process startup benchmarks need fork, %s cannot run on Windows",
+        startup_entry != xnullptr ? startup_bench->name : startup_argv[0]);
+}
+
+#endif
+
+// Samples the starts and fails the benchmark on the first problem
+static void startup_run(fossil_bench_t *bench, const char *name) {
+    startup_bench = bench;
+    startup_error[0] = '\0';
+    if (startup_marker != xnullptr && strlen(startup_marker) >= STARTUP_MARKER_MAX) {
+        startup_fail("the marker of %s is longer than %d bytes", name, STARTUP_MARKER_MAX - 1);
+    } else {
+        fossil_bench_run_case(bench, name, startup_sample);
+    }
+    if (startup_error[0] != '\0') {
+        _fossil_test_assert_class(false, TEST_ASSERT_AS_CLASS_EXPECT, startup_error, (char*)__FILE__, __LINE__, (char*)__func__);
+    }
+    startup_bench = xnullptr;
+    startup_argv = xnullptr;
+    startup_marker = xnullptr;
+    startup_entry = xnullptr;
+}
+
+void fossil_bench_run_startup(fossil_bench_t *bench, const char *name, const char *const *argv, const char *marker) {
+    if (bench == xnullptr || argv == xnullptr || argv[0] == xnullptr) {
+        return;
+    }
+    startup_argv = argv;
+    startup_marker = marker != xnullptr && marker[0] != '\0' ? marker : xnullptr;
+    startup_run(bench, name);
+}
+
+void fossil_bench_run_entry(fossil_bench_t *bench, const char *name, fossil_bench_entry_t entry) {
+    if (bench == xnullptr || entry == xnullptr) {
+        return;
+    }
+    startup_entry = entry;
+    startup_run(bench, name);
+}
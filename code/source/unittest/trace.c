@@ -0,0 +1,205 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/unittest/trace.h"
+#include "fossil/_common/platform.h"
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// ==============================================================================
+// Xtest functions for the trace of a run
+// ==============================================================================
+
+//
+// local types
+//
+
+typedef struct trace_chunk_t trace_chunk_t;
+struct trace_chunk_t {
+    int32_t used;
+    fossil_test_trace_span_t spans[FOSSIL_TEST_TRACE_CHUNK];
+    trace_chunk_t *next;
+};
+
+// Spans of one thread, the thread owns the tail and the writer reads it after the run
+typedef struct trace_buffer_t trace_buffer_t;
+struct trace_buffer_t {
+    int32_t thread_id;
+    trace_chunk_t *head;
+    trace_chunk_t *tail;
+    trace_buffer_t *next;
+};
+
+// GIVEN, WHEN or THEN step that has not ended yet
+typedef struct {
+    const char *description;
+    uint64_t begin_ns;
+} trace_step_t;
+
+fossil_test_trace_t _TEST_TRACE = { false, 0 };
+
+static _Thread_local trace_buffer_t *trace_local = xnullptr;
+static _Thread_local trace_step_t trace_steps[FOSSIL_TEST_TRACE_STEPS];
+
+static trace_buffer_t *trace_buffers = xnullptr;
+static int32_t trace_thread_count = 0;
+#ifdef _WIN32
+static SRWLOCK trace_lock = SRWLOCK_INIT;
+#else
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static const char *const trace_step_names[FOSSIL_TEST_TRACE_STEPS] = { "given", "when", "then" };
+
+// Registers the buffer of the calling thread, thread ids follow first use
+static trace_buffer_t *trace_buffer(void) {
+    if (trace_local != xnullptr) {
+        return trace_local;
+    }
+    trace_buffer_t *buffer = (trace_buffer_t*)calloc(1, sizeof(*buffer));
+    if (buffer == xnullptr) {
+        return xnullptr;
+    }
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&trace_lock);
+#else
+    pthread_mutex_lock(&trace_lock);
+#endif
+    buffer->thread_id = ++trace_thread_count;
+    buffer->next = trace_buffers;
+    trace_buffers = buffer;
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&trace_lock);
+#else
+    pthread_mutex_unlock(&trace_lock);
+#endif
+    trace_local = buffer;
+    return buffer;
+}
+
+void fossil_test_trace_start(void) {
+    _TEST_TRACE.origin_ns = fossil_test_clock_ns();
+    _TEST_TRACE.enabled = trace_buffer() != xnullptr; // the runner is thread 1
+}
+
+void fossil_test_trace_record(const char *category, const char *name, int32_t worker, uint64_t begin_ns, uint64_t end_ns) {
+    trace_buffer_t *buffer = trace_buffer();
+    if (buffer == xnullptr || begin_ns == 0) {
+        return; // a span that began before the trace started is left out
+    }
+    trace_chunk_t *chunk = buffer->tail;
+    if (chunk == xnullptr || chunk->used == FOSSIL_TEST_TRACE_CHUNK) {
+        chunk = (trace_chunk_t*)malloc(sizeof(*chunk));
+        if (chunk == xnullptr) {
+            return; // the span is lost, the run goes on
+        }
+        chunk->used = 0;
+        chunk->next = xnullptr;
+        if (buffer->tail != xnullptr) {
+            buffer->tail->next = chunk;
+        } else {
+            buffer->head = chunk;
+        }
+        buffer->tail = chunk;
+    }
+    fossil_test_trace_span_t *span = &chunk->spans[chunk->used++];
+    span->category = category;
+    span->name = name != xnullptr ? name : "";
+    span->worker = worker;
+    span->begin_ns = begin_ns;
+    span->end_ns = end_ns;
+}
+
+// Ends the open steps from the given level inwards
+static void trace_steps_end(int32_t level, uint64_t now) {
+    for (int32_t i = FOSSIL_TEST_TRACE_STEPS - 1; i >= level; i--) {
+        if (trace_steps[i].description != xnullptr) {
+            fossil_test_trace_record(trace_step_names[i], trace_steps[i].description, 0, trace_steps[i].begin_ns, now);
+            trace_steps[i].description = xnullptr;
+        }
+    }
+}
+
+void fossil_test_trace_step(int32_t level, const char *description) {
+    if (!_TEST_TRACE.enabled || level < 0 || level >= FOSSIL_TEST_TRACE_STEPS) {
+        return;
+    }
+    uint64_t now = fossil_test_clock_ns();
+    trace_steps_end(level, now);
+    trace_steps[level].description = description != xnullptr ? description : "";
+    trace_steps[level].begin_ns = now;
+}
+
+void fossil_test_trace_steps_close(void) {
+    if (_TEST_TRACE.enabled) {
+        trace_steps_end(0, fossil_test_clock_ns());
+    }
+}
+
+static void trace_json_string(FILE *out, const char *text) {
+    fputc('"', out);
+    for (; *text != '\0'; text++) {
+        if (*text == '"' || *text == '\\') {
+            fprintf(out, "\\%c", *text);
+        } else if ((unsigned char)*text < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned)(unsigned char)*text);
+        } else {
+            fputc(*text, out);
+        }
+    }
+    fputc('"', out);
+}
+
+// Microseconds since the start of the trace with nanosecond digits, the unit of the format
+static double trace_us(uint64_t ns) {
+    return ns > _TEST_TRACE.origin_ns ? (double)(ns - _TEST_TRACE.origin_ns) / 1000.0 : 0.0;
+}
+
+bool fossil_test_trace_save(const char *path) {
+    _TEST_TRACE.enabled = false;
+    FILE *file = fopen(path, "w");
+    bool first = true;
+    if (file != xnullptr) {
+        fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    }
+    while (trace_buffers != xnullptr) {
+        trace_buffer_t *buffer = trace_buffers;
+        if (file != xnullptr) {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+                first ? "" : ",\n", buffer->thread_id, buffer->thread_id == 1 ? "runner" : "thread", buffer->thread_id);
+            first = false;
+        }
+        while (buffer->head != xnullptr) {
+            trace_chunk_t *chunk = buffer->head;
+            for (int32_t i = 0; i < chunk->used && file != xnullptr; i++) {
+                const fossil_test_trace_span_t *span = &chunk->spans[i];
+                fprintf(file, ",\n{\"name\":");
+                trace_json_string(file, span->name);
+                fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"worker\":%d}}",
+                    span->category, trace_us(span->begin_ns), (double)(span->end_ns - span->begin_ns) / 1000.0,
+                    buffer->thread_id, span->worker);
+            }
+            buffer->head = chunk->next;
+            free(chunk);
+        }
+        trace_buffers = buffer->next;
+        free(buffer);
+    }
+    trace_local = xnullptr; // buffers of other threads went with them
+    trace_thread_count = 0;
+    if (file == xnullptr) {
+        return false;
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
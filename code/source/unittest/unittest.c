@@ -14,9 +14,14 @@ Description:
 #include "fossil/_common/common.h"
 #include "fossil/unittest/console.h"
 #include "fossil/unittest/commands.h"
+#include "fossil/unittest/benchmark.h"
+#include "fossil/unittest/baseline.h"
+#include "fossil/unittest/host.h"
+#include "fossil/unittest/trace.h"
 #include <stdarg.h>
 
 #define MAX_ASSERT_HISTORY 100
+#define FOSSIL_TEST_ARENA_BLOCK 4096
 
 typedef struct {
     bool expression;
@@ -34,8 +39,89 @@ static int assert_history_count = 0;
 fossil_env_t _TEST_ENV;
 xassert_info _ASSERT_INFO;
 
+static size_t heap_alloc_count = 0;
+
+// Single counted entry point for the runner's own heap usage
+static void *fossil_test_heap_alloc(size_t size) {
+    heap_alloc_count++;
+    return malloc(size);
+}
+
+size_t fossil_test_heap_allocs(void) {
+    return heap_alloc_count;
+}
+
+//
+// Fossil Test arena functions
+//
+
+struct fossil_test_arena_block_t {
+    fossil_test_arena_block_t *next; // previously filled block
+    size_t used;                     // bytes handed out from data
+    size_t capacity;                 // bytes available in data
+    max_align_t data[];              // storage, aligned for any type
+};
+
+void *fossil_test_arena_alloc(fossil_test_arena_t *arena, size_t size) {
+    if (arena == xnullptr) {
+        return xnullptr;
+    }
+
+    // round up so every allocation keeps the block aligned
+    size = (size + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+
+    fossil_test_arena_block_t *block = arena->head;
+    if (block == xnullptr || block->capacity - block->used < size) {
+        size_t capacity = size > FOSSIL_TEST_ARENA_BLOCK ? size : FOSSIL_TEST_ARENA_BLOCK;
+        block = (fossil_test_arena_block_t*)fossil_test_heap_alloc(sizeof(fossil_test_arena_block_t) + capacity);
+        if (block == xnullptr) {
+            perror("Failed to allocate memory for test arena");
+            return xnullptr;
+        }
+        block->used = 0;
+        block->capacity = capacity;
+        block->next = arena->head;
+        arena->head = block;
+    }
+
+    void *ptr = (char*)block->data + block->used;
+    block->used += size;
+    return ptr;
+}
+
+char *fossil_test_arena_strdup(fossil_test_arena_t *arena, const char *str) {
+    if (str == xnullptr) {
+        return xnullptr;
+    }
+
+    size_t len = strlen(str);
+    char *dup = (char*)fossil_test_arena_alloc(arena, len + 1);
+    if (dup != xnullptr) {
+        memcpy(dup, str, len + 1);
+    }
+    return dup;
+}
+
+void fossil_test_arena_erase(fossil_test_arena_t *arena) {
+    if (arena == xnullptr) {
+        return;
+    }
+
+    fossil_test_arena_block_t *block = arena->head;
+    while (block != xnullptr) {
+        fossil_test_arena_block_t *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = xnullptr;
+}
+
+//
+// Fossil Test queue functions
+//
+
 fossil_test_queue_t* fossil_test_queue_create(void) {
-    fossil_test_queue_t* queue = (fossil_test_queue_t*)malloc(sizeof(fossil_test_queue_t));
+    fossil_test_queue_t* queue = (fossil_test_queue_t*)fossil_test_heap_alloc(sizeof(fossil_test_queue_t));
     if (queue != xnullptr) {
         queue->front = xnullptr;
         queue->rear = xnullptr;
@@ -227,7 +313,7 @@ fossil_test_t** queue_to_array(fossil_test_queue_t *queue, int *size) {
         current = current->next;
     }
 
-    fossil_test_t **array = (fossil_test_t**)malloc(count * sizeof(fossil_test_t*));
+    fossil_test_t **array = (fossil_test_t**)fossil_test_heap_alloc(count * sizeof(fossil_test_t*));
     current = queue->front;
     for (int i = 0; i < count; i++) {
         array[i] = current;
@@ -286,6 +372,7 @@ void fossil_test_environment_erase(void) {
     if (_TEST_ENV.queue != xnullptr) {
         free(_TEST_ENV.queue);  // Fix memory leak by uncommenting free statement
     }
+    fossil_test_arena_erase(&_TEST_ENV.arena);
 }
 
 fossil_env_t fossil_test_environment_create(int argc, char **argv) {
@@ -321,8 +408,20 @@ fossil_env_t fossil_test_environment_create(int argc, char **argv) {
     env.timer.detail.microseconds = 0;
     env.timer.detail.nanoseconds = 0;
 
-    // Initialize test queue
+    // Initialize test queue and the arena backing per-test strings
     env.queue = fossil_test_queue_create();
+    env.arena.head = xnullptr;
+    env.current_group = xnullptr;
+
+    // Per-test timings are sized once the queue is final
+    env.timings = xnullptr;
+    env.timing_count = 0;
+    env.timing_capacity = 0;
+    env.benches = xnullptr;
+    env.ranges = xnullptr;
+    env.scalings = xnullptr;
+    env.working_sets = xnullptr;
+    env.ab_benches = xnullptr;
     atexit(fossil_test_environment_erase); // ensure memory leaks do not occur
 
     // Initialize exception and assumption counts
@@ -408,6 +507,7 @@ void fossil_test_run_testcase(fossil_test_t *test) {
     _ASSERT_INFO.shoudl_timeout = false;
     _ASSERT_INFO.num_asserts    = 0;
     _ASSERT_INFO.same_assert    = false;
+    _ASSERT_INFO.operands.kind  = TEST_OPERAND_AS_NONE;
 
     if (_TEST_ENV.rule.skipped && strcmp(test->marks, "skip") == 0) {
         return;
@@ -416,24 +516,126 @@ void fossil_test_run_testcase(fossil_test_t *test) {
     }
 
     fossil_test_io_unittest_start(test);
+
+    // benchmarks read the counters around their own samples
+    fossil_bench_counters_t counters_begin;
+    fossil_bench_counters_t counters = {{false}, {0}};
+    bool counting = _CLI.counters_enabled && test->bench == xnullptr && !_CLI.bench_mode && fossil_bench_counters_open();
+    if (counting) {
+        fossil_bench_counters_read(&counters_begin);
+    }
+
+    // benchmarks count the allocations of their own samples as well
+    fossil_test_allocs_t allocs;
+    bool counting_allocs = _CLI.allocs_enabled && test->bench == xnullptr && !_CLI.bench_mode;
+
+    uint64_t started_ns = fossil_test_clock_ns();
+    fossil_test_io_capture_begin();
+    if (counting_allocs) {
+        fossil_test_allocs_begin(&allocs);
+    }
     if (test->fixture.setup != xnullptr) {
+        uint64_t traced = fossil_test_trace_begin();
         test->fixture.setup();
+        fossil_test_trace_end("setup", test->name, 0, traced);
     }
 
-    // Run the test function
-    for (int32_t iter = 0; iter < _CLI.repeat_count; iter++) {
+    // Run the test function, in bench mode the repeats are the samples
+    uint64_t traced = fossil_test_trace_begin();
+    if (_CLI.bench_mode && test->bench == xnullptr) {
+        fossil_bench_t *bench = (fossil_bench_t*)fossil_test_arena_alloc(&_TEST_ENV.arena, sizeof(*bench));
+        if (bench != xnullptr) {
+            memset(bench, 0, sizeof(*bench));
+            fossil_bench_run_case(bench, test->name, test->test_function);
+        }
+    } else if (_CLI.bench_mode) {
         test->test_function();
+    } else {
+        for (int32_t iter = 0; iter < _CLI.repeat_count; iter++) {
+            test->test_function();
+        }
+    }
+    if (_TEST_TRACE.enabled) {
+        fossil_test_trace_steps_close();
+        fossil_test_trace_end("test", test->name, 0, traced);
     }
     fossil_test_io_unittest_step(&_ASSERT_INFO);
 
     if (test->fixture.teardown != xnullptr) {
+        traced = fossil_test_trace_begin();
         test->fixture.teardown();
+        fossil_test_trace_end("teardown", test->name, 0, traced);
+    }
+    if (counting_allocs) {
+        fossil_test_allocs_end(&allocs);
+    }
+    fossil_test_io_capture_ended(!_TEST_ENV.rule.should_pass);
+    if (counting_allocs) {
+        fossil_test_io_allocs(&allocs, 1);
+    }
+
+    if (counting) {
+        fossil_bench_counters_t counters_end;
+        if (fossil_bench_counters_read(&counters_end)) {
+            fossil_bench_counters_accumulate(&counters, &counters_begin, &counters_end);
+            fossil_test_io_counters(&counters, 1);
+        }
+    }
+
+    if (_TEST_ENV.timing_count < _TEST_ENV.timing_capacity) {
+        fossil_test_timing_t *timing = &_TEST_ENV.timings[_TEST_ENV.timing_count++];
+        timing->elapsed_ns = fossil_test_clock_ns() - started_ns;
+        timing->test = test;
     }
 
     fossil_test_io_unittest_ended(test);
     fossil_test_environment_scoreboard(test);
 }
 
+// Unlinks every case the filter does not keep, the cases are not owned by the
+// queue and stay untouched.
+static void fossil_test_queue_keep(fossil_env_t *env, bool (*keep)(const fossil_test_t *test)) {
+    fossil_test_t *current = env->queue->front;
+    while (current != xnullptr) {
+        fossil_test_t *next = current->next;
+        if (!keep(current)) {
+            if (current->prev != xnullptr) {
+                current->prev->next = next;
+            } else {
+                env->queue->front = next;
+            }
+            if (next != xnullptr) {
+                next->prev = current->prev;
+            } else {
+                env->queue->rear = current->prev;
+            }
+            current->next = xnullptr;
+            current->prev = xnullptr;
+            env->stats.untested_count--; // left out on purpose, not a ghost
+        }
+        current = next;
+    }
+}
+
+// Benchmarks and cases tagged "performance"
+static bool fossil_test_keep_bench(const fossil_test_t *test) {
+    return test->bench != xnullptr || strcmp(test->tags, "performance") == 0;
+}
+
+// Cases tagged with one of the comma separated tags given to only
+static bool fossil_test_keep_only(const fossil_test_t *test) {
+    const char *tag = _CLI.only_tags_value;
+    size_t length = strlen(test->tags);
+    while (*tag != '\0') {
+        size_t span = strcspn(tag, ",");
+        if (span == length && strncmp(tag, test->tags, span) == 0) {
+            return true;
+        }
+        tag += span + (tag[span] == ',');
+    }
+    return false;
+}
+
 void fossil_test_environment_algorithms(fossil_env_t *env) {
     if (env == xnullptr) {
         return;
@@ -449,12 +651,12 @@ void fossil_test_environment_algorithms(fossil_env_t *env) {
         fossil_test_queue_reverse(env->queue);
     }
 
-    if (_CLI.only_tags) {
-        fossil_test_t *test = fossil_test_queue_search_by_tag(env->queue, _CLI.only_tags_value);
-        if (test != xnullptr) {
-            fossil_test_queue_erase(env->queue);
-            add_test_to_queue(test, env->queue);
-        }
+    if (_CLI.bench_mode) {
+        fossil_test_queue_keep(env, fossil_test_keep_bench);
+    }
+
+    if (_CLI.only_tags && _CLI.only_tags_value[0] != '\0') {
+        fossil_test_queue_keep(env, fossil_test_keep_only);
     }
 }
 
@@ -466,17 +668,52 @@ void fossil_test_environment_run(fossil_env_t *env) {
     // Apply the test environment algorithms for the given test cases
     fossil_test_environment_algorithms(env);
 
-    
+    int32_t total = 0;
+    bool benches = false;
+    for (fossil_test_t *test = env->queue->front; test != xnullptr; test = test->next) {
+        total++;
+        benches = benches || test->bench != xnullptr;
+    }
+
+    // One compact array for every timing of this run
+    env->timings = (fossil_test_timing_t*)fossil_test_arena_alloc(&env->arena, (size_t)total * sizeof(fossil_test_timing_t));
+    env->timing_capacity = env->timings != xnullptr ? total : 0;
+    env->timing_count = 0;
+
+    if (benches) {
+        fossil_bench_host_prepare();
+    }
+    fossil_bench_clock_calibrate(); // not inside the first timed case
+    if (_CLI.trace_file[0] != '\0') {
+        fossil_test_trace_start();
+    }
+    fossil_test_io_capture_start();
+    fossil_test_io_progress_start(env->queue, total);
 
     // Iterate through the test queue and run each test
     fossil_test_t *current_test = env->queue->front;
     while (current_test != xnullptr) {
         // Run the test function
         fossil_test_run_testcase(current_test);
+        fossil_test_io_progress_update(current_test);
 
         // Move to the next test
         current_test = current_test->next;
     }
+    fossil_test_io_capture_stop();
+    fossil_bench_counters_close();
+    fossil_test_io_progress_ended();
+
+    // Keep the samples of this run as a baseline for later runs
+    if (_CLI.bench_save_file[0] != '\0' && !fossil_bench_save(_CLI.bench_save_file, env->benches)) {
+        fossil_test_cout("red", "could not write benchmark baseline %s\n", _CLI.bench_save_file);
+    }
+    if (_CLI.bench_histogram_file[0] != '\0' && !fossil_bench_latency_save(_CLI.bench_histogram_file, env->benches, env->scalings)) {
+        fossil_test_cout("red", "could not write latency histograms %s\n", _CLI.bench_histogram_file);
+    }
+    if (_CLI.trace_file[0] != '\0' && !fossil_test_trace_save(_CLI.trace_file)) {
+        fossil_test_cout("red", "could not write trace %s\n", _CLI.trace_file);
+    }
 
     // Stop the timer
     env->timer.end = clock();
@@ -506,12 +743,35 @@ void fossil_test_environment_add(fossil_env_t *env, fossil_test_t *test, fossil_
         test->fixture.teardown = fixture->teardown;
     }
 
+    test->group = env->current_group;
+
+    // Compute the display name once so reporting stays allocation free
+    if (test->display_name == xnullptr) {
+        char *display = fossil_test_arena_strdup(&env->arena, test->name);
+        if (display != xnullptr) {
+            for (char *ptr = display; *ptr; ptr++) {
+                if (*ptr == '_') {
+                    *ptr = ' ';
+                }
+            }
+        }
+        test->display_name = display != xnullptr ? display : test->name;
+    }
+
     // Update test statistics
     add_test_to_queue(test, env->queue);
     _TEST_ENV.stats.untested_count++;
     fossil_test_io_sanity_load(test);
 }
 
+// Function to name the test group whose tests are about to be added
+void fossil_test_environment_group(fossil_env_t *env, const char *group_name) {
+    if (env == xnullptr) {
+        return;
+    }
+    env->current_group = group_name;
+}
+
 //
 // Feature function implementations
 //
@@ -534,8 +794,7 @@ void fossil_test_apply_mark(fossil_test_t *test, const char *mark) {
         test->marks = "error";
         _TEST_ENV.rule.should_pass = false;
     } else if (strcmp(mark, "fail") == 0){
-        test->marks = "fail";
-        _TEST_ENV.rule.should_pass = false;
+        test->marks = "fail"; // the case itself turns it around when it runs
     } else if (strcmp(mark, "none") == 0) {
         test->marks = "none";
     } else if (strcmp(mark, "only") == 0) {
@@ -768,12 +1027,40 @@ bool is_assert_similar_in_history(unsigned long fingerprint) {
     return false;
 }
 
+bool _fossil_test_compare_bytes(const void *actual, const void *expected, size_t size) {
+    _ASSERT_INFO.operands.kind = TEST_OPERAND_AS_BYTES;
+    _ASSERT_INFO.operands.actual = actual;
+    _ASSERT_INFO.operands.expected = expected;
+    _ASSERT_INFO.operands.actual_size = size;
+    _ASSERT_INFO.operands.expected_size = size;
+
+    if (actual == xnullptr || expected == xnullptr) {
+        return actual == expected;
+    }
+    return memcmp(actual, expected, size) == 0;
+}
+
+bool _fossil_test_compare_text(const char *actual, const char *expected) {
+    _ASSERT_INFO.operands.kind = TEST_OPERAND_AS_TEXT;
+    _ASSERT_INFO.operands.actual = actual;
+    _ASSERT_INFO.operands.expected = expected;
+    _ASSERT_INFO.operands.actual_size = 0;
+    _ASSERT_INFO.operands.expected_size = 0;
+
+    if (actual == xnullptr || expected == xnullptr) {
+        return actual == expected;
+    }
+    return strcmp(actual, expected) == 0;
+}
+
 void _fossil_test_assert_class(bool expression, xassert_type_t behavior, char* message, char* file, int line, char* func) {
-    unsigned long fingerprint = generate_fingerprint(expression, behavior, message, file, line, func);
+    // bench mode keeps no history, every repeat of a case evaluates its asserts
+    unsigned long fingerprint = _CLI.bench_mode ? 0 : generate_fingerprint(expression, behavior, message, file, line, func);
 
-    if (is_assert_similar_in_history(fingerprint)) {
+    if (!_CLI.bench_mode && is_assert_similar_in_history(fingerprint)) {
         // Skip the assertion as a similar one has already been executed
          _ASSERT_INFO.same_assert = true;
+         _ASSERT_INFO.operands.kind = TEST_OPERAND_AS_NONE;
         return;
     }
 
@@ -792,9 +1079,10 @@ void _fossil_test_assert_class(bool expression, xassert_type_t behavior, char* m
 
     _ASSERT_INFO.num_asserts++; // increment the number of asserts
     _ASSERT_INFO.has_assert = true; // Make note of an assert being added in a given test case
+    _ASSERT_INFO.operands.kind = TEST_OPERAND_AS_NONE; // operands only belong to this assertion
 
     // Add the assertion to the history with its fingerprint
-    if (assert_history_count < MAX_ASSERT_HISTORY) {
+    if (!_CLI.bench_mode && assert_history_count < MAX_ASSERT_HISTORY) {
         assert_history[assert_history_count].expression = expression;
         assert_history[assert_history_count].behavior = behavior;
         assert_history[assert_history_count].message = message;
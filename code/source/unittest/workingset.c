@@ -0,0 +1,134 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description: 
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include "fossil/unittest/workingset.h"
+#include "fossil/unittest/console.h"
+#include "fossil/_common/platform.h"
+
+// ==============================================================================
+// Xmark functions for cache working set benchmarks
+// ==============================================================================
+
+// Lays the buffer out as one random cycle through its lines (Sattolo's
+// shuffle), from a fixed seed so every run visits the lines in the same order.
+static bool working_set_link(char *buffer, size_t bytes, size_t line) {
+    size_t count = bytes / line;
+    size_t *order = (size_t*)malloc(count * sizeof(*order));
+    if (order == xnullptr) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    for (size_t i = count - 1; i > 0; i--) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        size_t j = (size_t)(state % i);
+        size_t swap = order[i];
+        order[i] = order[j];
+        order[j] = swap;
+    }
+    for (size_t i = 0; i < count; i++) {
+        *(void**)(buffer + i * line) = buffer + order[i] * line;
+    }
+    free(order);
+    return true;
+}
+
+void *fossil_bench_working_set_chase(void *start, uint64_t steps) {
+    void *at = start;
+    for (uint64_t i = 0; i < steps; i++) {
+        at = *(void**)at;
+    }
+    return at;
+}
+
+// Runs the body on a working set of the given size, the benchmark of that
+// size is kept from an earlier run of the same working set benchmark.
+static fossil_bench_t *working_set_point(fossil_bench_working_set_t *working_set, fossil_bench_t *point, size_t bytes) {
+    size_t line = working_set->line_size;
+    bytes = bytes / line * line;
+    if (point == xnullptr) {
+        char label[FOSSIL_BENCH_NAME_MAX];
+        snprintf(label, sizeof(label), "%s/%lluK", working_set->bench.name, (unsigned long long)(bytes / 1024));
+        point = (fossil_bench_t*)fossil_test_arena_alloc(&_TEST_ENV.arena, sizeof(*point));
+        if (point == xnullptr) {
+            return xnullptr;
+        }
+        memset(point, 0, sizeof(*point));
+        point->name = fossil_test_arena_strdup(&_TEST_ENV.arena, label);
+    }
+    char *raw = (char*)malloc(bytes + line);
+    if (raw == xnullptr) {
+        fossil_test_cout("yellow", "could not allocate a working set of %llu bytes for %s\n", (unsigned long long)bytes, point->name);
+        return xnullptr;
+    }
+    char *buffer = raw + (line - (uintptr_t)raw % line) % line;
+    if (!working_set_link(buffer, bytes, line)) {
+        free(raw);
+        return xnullptr;
+    }
+    point->arg = (int64_t)bytes;
+    point->working_set = buffer;
+    fossil_bench_run(point, point->name, working_set->bench.function);
+    point->working_set = xnullptr;
+    free(raw);
+    return point;
+}
+
+// Adds the working set benchmark to the results of this run, once
+static void working_set_record(fossil_bench_working_set_t *working_set) {
+    fossil_bench_working_set_t **link = &_TEST_ENV.working_sets;
+    while (*link != xnullptr) {
+        if (*link == working_set) {
+            return;
+        }
+        link = &(*link)->next;
+    }
+    working_set->next = xnullptr;
+    *link = working_set;
+}
+
+void fossil_bench_run_working_set(fossil_bench_working_set_t *working_set, const char *name, fossil_bench_function_t function) {
+    if (working_set == xnullptr || function == xnullptr) {
+        return;
+    }
+    working_set->bench.name = name;
+    working_set->bench.function = function;
+    working_set->line_size = _fossil_test_get_cache_line_size();
+
+    // the larger working set is left out when it would take a quarter of the memory
+    size_t memory = (size_t)_fossil_test_get_memory_size() * 1024 * 1024;
+    bool any = false;
+    for (int32_t i = 0; i < FOSSIL_BENCH_WORKING_SET_LEVELS; i++) {
+        fossil_bench_working_set_level_t *level = &working_set->levels[i];
+        level->level = i + 1;
+        level->cache_bytes = _fossil_test_get_cache_size(i + 1);
+        if (level->cache_bytes < 4 * working_set->line_size) {
+            level->cache_bytes = 0;
+            continue;
+        }
+        any = true;
+        level->below = working_set_point(working_set, level->below, level->cache_bytes / 4 * 3);
+        if (memory == 0 || level->cache_bytes * 2 <= memory / 4) {
+            level->above = working_set_point(working_set, level->above, level->cache_bytes * 2);
+        }
+    }
+    if (!any) {
+        fossil_test_cout("yellow", "the cache sizes of this host are unknown, %s has nothing to run\n", name);
+        return;
+    }
+    working_set_record(working_set);
+    fossil_test_io_bench_working_set(working_set);
+}
@@ -0,0 +1,206 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include <fossil/unittest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+#include <fossil/unittest/commands.h> // runner options
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// Setup steps for things like test fixtures and
+// mock objects are set here.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+enum {
+    STEADY_RUNS = 3 // runs of the inner case counted once warmed up
+};
+
+FOSSIL_FIXTURE(steady_fixture);
+
+FOSSIL_SETUP(steady_fixture) {
+    // nothing to set up, only the path through the fixture matters
+} // end of setup
+
+FOSSIL_TEARDOWN(steady_fixture) {
+    // nothing to tear down
+} // end of teardown
+
+// Run by steady_state_reporting through the runner, never added to a group
+FOSSIL_TEST(steady_state_inner_case) {
+    ASSUME_ITS_TRUE(steady_state_inner_case.fixture.setup != xnull);
+}
+
+// Runs the inner case the way a group runs it, with its report going to out.
+// What the run counts is put back, the outer case is not scored for it.
+static void steady_state_run(FILE *out) {
+    fossil_test_score_t stats = _TEST_ENV.stats;
+    fossil_test_rule_t rule = _TEST_ENV.rule;
+    int32_t timing_count = _TEST_ENV.timing_count;
+    xassert_info info = _ASSERT_INFO;
+    FILE *previous = fossil_test_io_console(out);
+    fossil_test_run_testcase(&steady_state_inner_case);
+    fossil_test_io_console(previous);
+    _TEST_ENV.stats = stats;
+    _TEST_ENV.rule = rule;
+    _TEST_ENV.timing_count = timing_count;
+    _ASSERT_INFO = info;
+}
+
+enum {
+    TIMING_CASES = 100, // cases of 1 us up to 100 us
+    TIMING_GROUPS = 70  // more groups than the summary used to keep
+};
+
+// Renders the timing section of the summary for the given timings without
+// colors and reads it back into render
+static void timing_render(fossil_test_timing_t *timings, int32_t count, char *render, size_t size) {
+    render[0] = '\0';
+    FILE *out = tmpfile();
+    if (out == xnull) {
+        return;
+    }
+    int slowest_count = _CLI.slowest_count;
+    bool color_enabled = _CLI.color_enabled;
+    _CLI.slowest_count = 3;
+    _CLI.color_enabled = false;
+    FILE *previous = fossil_test_io_console(out);
+    fossil_test_io_timings(timings, count);
+    fossil_test_io_console(previous);
+    _CLI.slowest_count = slowest_count;
+    _CLI.color_enabled = color_enabled;
+
+    rewind(out);
+    size_t read = fread(render, 1, size - 1, out);
+    render[read] = '\0';
+    fclose(out);
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// The test cases below are provided as samples, inspired
+// by the Meson build system's approach of using test cases
+// as samples for library usage.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST(arena_try_strdup_and_erase) {
+    fossil_test_arena_t arena = { xnull };
+
+    char *first = fossil_test_arena_strdup(&arena, "fossil_arena_case");
+    char *second = fossil_test_arena_strdup(&arena, "");
+    ASSUME_NOT_CNULL(first);
+    ASSUME_NOT_CNULL(second);
+    ASSUME_ITS_EQUAL_CSTR("fossil_arena_case", first);
+    ASSUME_ITS_EQUAL_CSTR("", second);
+
+    fossil_test_arena_erase(&arena);
+    ASSUME_ITS_CNULL(arena.head);
+}
+
+FOSSIL_TEST(arena_try_large_and_aligned_alloc) {
+    fossil_test_arena_t arena = { xnull };
+
+    char *small = (char*)fossil_test_arena_alloc(&arena, 3);
+    char *large = (char*)fossil_test_arena_alloc(&arena, 64 * 1024);
+    ASSUME_NOT_CNULL(small);
+    ASSUME_NOT_CNULL(large);
+    ASSUME_ITS_EQUAL_SIZE((uintptr_t)small % _Alignof(max_align_t), 0);
+    ASSUME_ITS_EQUAL_SIZE((uintptr_t)large % _Alignof(max_align_t), 0);
+
+    memset(large, 0x5a, 64 * 1024); // whole block must be writable
+    ASSUME_ITS_TRUE(large[64 * 1024 - 1] == 0x5a);
+
+    fossil_test_arena_erase(&arena);
+}
+
+FOSSIL_TEST(arena_display_name_is_precomputed) {
+    ASSUME_NOT_CNULL(arena_display_name_is_precomputed.display_name);
+    ASSUME_ITS_EQUAL_CSTR("arena display name is precomputed", arena_display_name_is_precomputed.display_name);
+}
+
+// Everything the runner does for a case once the run is going: setup,
+// teardown, capture, the report and the timings. Real heap allocations are
+// counted through the allocator hooks, none should happen.
+FOSSIL_TEST(steady_state_reporting) {
+    FILE *out = tmpfile();
+    ASSUME_NOT_CNULL(out);
+    if (out == xnull) {
+        return;
+    }
+    steady_state_inner_case.display_name = "steady state inner case";
+    steady_state_inner_case.group = "arena_group";
+    steady_state_inner_case.fixture.setup = steady_fixture.setup;
+    steady_state_inner_case.fixture.teardown = steady_fixture.teardown;
+
+    fossil_test_io_capture_ended(false); // the inner case captures its own output
+    steady_state_run(out); // the first write gives the stream its buffer
+    fossil_test_allocs_t allocs;
+    fossil_test_allocs_begin(&allocs);
+    for (int i = 0; i < STEADY_RUNS; i++) {
+        steady_state_run(out);
+    }
+    fossil_test_allocs_end(&allocs);
+    fossil_test_io_capture_begin();
+    fclose(out);
+
+    ASSUME_ITS_TRUE(!fossil_test_allocs_available() || allocs.valid);
+    ASSUME_ITS_EQUAL_U64(0, allocs.allocs);
+}
+
+FOSSIL_TEST(timing_summary_slowest_and_percentiles) {
+    static fossil_test_t cases[TIMING_CASES];
+    static fossil_test_timing_t timings[TIMING_CASES];
+    static char names[TIMING_CASES][16];
+    static char groups[TIMING_GROUPS][16];
+    static char render[16384];
+    for (int32_t i = 0; i < TIMING_CASES; i++) {
+        snprintf(names[i], sizeof(names[i]), "case %d", (int)i + 1);
+        if (i < TIMING_GROUPS) {
+            snprintf(groups[i], sizeof(groups[i]), "group %d", (int)i + 1);
+        }
+        cases[i].name = names[i];
+        cases[i].group = groups[i % TIMING_GROUPS];
+        cases[i].tags = i < TIMING_CASES / 2 ? "fast" : "slow";
+        // recorded out of order, case i + 1 took i + 1 us
+        int32_t slot = (i * 37) % TIMING_CASES;
+        timings[slot].elapsed_ns = (uint64_t)(i + 1) * 1000;
+        timings[slot].test = &cases[i];
+    }
+    timing_render(timings, TIMING_CASES, render, sizeof(render));
+
+    // sorted slowest first, only the requested number is listed
+    ASSUME_ITS_EQUAL_U64(100000, timings[0].elapsed_ns);
+    ASSUME_ITS_EQUAL_U64(1000, timings[TIMING_CASES - 1].elapsed_ns);
+    ASSUME_NOT_CNULL(strstr(render, "    1.  100.000 us  case 100 (slow)"));
+    ASSUME_NOT_CNULL(strstr(render, "    3.   98.000 us  case 98 (slow)"));
+    ASSUME_ITS_CNULL(strstr(render, "    4. "));
+    // nearest rank percentiles
+    ASSUME_NOT_CNULL(strstr(render, "p50   50.000 us  p90   90.000 us  p99   99.000 us  max  100.000 us"));
+    // every tag and group is kept
+    ASSUME_NOT_CNULL(strstr(render, "  fast                                 50 cases"));
+    ASSUME_NOT_CNULL(strstr(render, "  group 1                               2 cases"));
+    ASSUME_NOT_CNULL(strstr(render, "  group 70                              1 cases"));
+    ASSUME_ITS_CNULL(strstr(render, "not shown"));
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+FOSSIL_TEST_GROUP(arena_group) {
+    ADD_TEST(arena_try_strdup_and_erase);
+    ADD_TEST(arena_try_large_and_aligned_alloc);
+    ADD_TEST(arena_display_name_is_precomputed);
+    ADD_TEST(timing_summary_slowest_and_percentiles);
+
+    ADD_TEST(steady_state_reporting);
+} // end of fixture
@@ -124,6 +124,35 @@ FOSSIL_SONIREO(xbdd_valid_login) {
     }
 } // end of case
 
+FOSSIL_TEST(xbdd_steps_are_traced) {
+    char text[2048] = {0};
+    bool tracing = _TEST_TRACE.enabled; // a run with trace keeps its own file
+    if (!tracing) {
+        fossil_test_trace_start();
+    }
+    GIVEN("a traced step") {
+        THEN("it ends with the body") {
+            TEST_EXPECT(_TEST_TRACE.enabled, "Spans should be recorded");
+        }
+    }
+    if (tracing) {
+        return;
+    }
+    fossil_test_trace_steps_close();
+    TEST_ASSUME(fossil_test_trace_save("xbdd_trace.json"), "The trace should be written");
+    FILE *file = fopen("xbdd_trace.json", "r");
+    if (file != xnull) {
+        size_t length = fread(text, 1, sizeof(text) - 1, file);
+        text[length] = '\0';
+        fclose(file);
+    }
+    remove("xbdd_trace.json");
+    TEST_EXPECT(strstr(text, "\"traceEvents\"") != xnull, "The trace should be in the trace event format");
+    TEST_EXPECT(strstr(text, "{\"name\":\"a traced step\",\"cat\":\"given\",\"ph\":\"X\"") != xnull, "GIVEN should be a span");
+    TEST_EXPECT(strstr(text, "\"cat\":\"then\"") != xnull, "THEN should be a span");
+    TEST_EXPECT(!_TEST_TRACE.enabled, "Saving should stop the trace");
+} // end of case
+
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Pool
 // * * * * * * * * * * * * * * * * * * * * * * * *
@@ -132,4 +161,5 @@ FOSSIL_TEST_GROUP(bdd_test_group) {
     ADD_TEST(xbdd_user_account);
     ADD_TEST(xbdd_empty_cart);
     ADD_TEST(xbdd_valid_login);
+    ADD_TEST(xbdd_steps_are_traced);
 } // end of group
@@ -11,6 +11,11 @@ Description:
 ==============================================================================
 */
 #include <fossil/unittest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+#include <fossil/unittest/baseline.h>
+#include <fossil/unittest/commands.h>
+#include <fossil/unittest/host.h>
+#include <math.h>
 
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Utilites
@@ -61,6 +66,14 @@ void selection_sort(int *array, size_t size) {
     }
 }
 
+// Busy waits so the timers have something to measure
+static void spin_for_ns(uint64_t ns) {
+    uint64_t until = fossil_test_clock_ns() + ns;
+    while (fossil_test_clock_ns() < until) {
+        // spin
+    }
+}
+
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Cases
 // * * * * * * * * * * * * * * * * * * * * * * * *
@@ -76,6 +89,7 @@ FOSSIL_TEST(bubble_sort_case_1) {
     size_t size = sizeof(data) / sizeof(data[0]);
     TEST_BENCHMARK();
     bubble_sort(data, size);
+    FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
     TEST_DURATION_SEC(TEST_CURRENT_TIME(), 1.0);
 }
 
@@ -85,6 +99,7 @@ FOSSIL_TEST(bubble_sort_case_2) {
     size_t size = sizeof(data) / sizeof(data[0]);
     TEST_BENCHMARK();
     bubble_sort(data, size);
+    FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
     TEST_DURATION_SEC(TEST_CURRENT_TIME(), 1.0);
 }
 
@@ -94,6 +109,7 @@ FOSSIL_TEST(bubble_sort_case_3) {
     size_t size = sizeof(data) / sizeof(data[0]);
     TEST_BENCHMARK();
     bubble_sort(data, size);
+    FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
     TEST_DURATION_SEC(TEST_CURRENT_TIME(), 1.0);
 }
 
@@ -104,6 +120,7 @@ FOSSIL_TEST(insertion_sort_case_1) {
     size_t size = sizeof(data) / sizeof(data[0]);
     TEST_BENCHMARK();
     insertion_sort(data, size);
+    FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
     TEST_DURATION_SEC(TEST_CURRENT_TIME(), 1.0);
 }
 
@@ -113,6 +130,7 @@ FOSSIL_TEST(insertion_sort_case_2) {
     size_t size = sizeof(data) / sizeof(data[0]);
     TEST_BENCHMARK();
     insertion_sort(data, size);
+    FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
     TEST_DURATION_SEC(TEST_CURRENT_TIME(), 1.0);
 }
 
@@ -122,6 +140,7 @@ FOSSIL_TEST(insertion_sort_case_3) {
     size_t size = sizeof(data) / sizeof(data[0]);
     TEST_BENCHMARK();
     insertion_sort(data, size);
+    FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
     TEST_DURATION_SEC(TEST_CURRENT_TIME(), 1.0);
 }
 
@@ -132,6 +151,7 @@ FOSSIL_TEST(selection_sort_case_1) {
     size_t size = sizeof(data) / sizeof(data[0]);
     TEST_BENCHMARK();
     selection_sort(data, size);
+    FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
     TEST_DURATION_SEC(TEST_CURRENT_TIME(), 1.0);
 }
 
@@ -141,6 +161,7 @@ FOSSIL_TEST(selection_sort_case_2) {
     size_t size = sizeof(data) / sizeof(data[0]);
     TEST_BENCHMARK();
     selection_sort(data, size);
+    FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
     TEST_DURATION_SEC(TEST_CURRENT_TIME(), 1.0);
 }
 
@@ -150,9 +171,585 @@ FOSSIL_TEST(selection_sort_case_3) {
     size_t size = sizeof(data) / sizeof(data[0]);
     TEST_BENCHMARK();
     selection_sort(data, size);
+    FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
     TEST_DURATION_SEC(TEST_CURRENT_TIME(), 1.0);
 }
 
+// Statistical benchmarks, every iteration sorts a fresh copy of the input
+FOSSIL_BENCH(bubble_sort_latency) {
+    int data[64];
+    FOSSIL_BENCH_RECORD_LATENCY(bench);
+    FOSSIL_BENCH_LOOP(bench) {
+        for (int i = 0; i < 64; i++) {
+            data[i] = 64 - i;
+        }
+        bubble_sort(data, 64);
+        FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
+    }
+}
+
+FOSSIL_BENCH(insertion_sort_bench) {
+    int input[] = {8, 2, 4, 1, 7, 5, 9, 3, 6};
+    int data[sizeof(input) / sizeof(input[0])];
+    FOSSIL_BENCH_EXPECT_ALLOCS(bench, 0);
+    FOSSIL_BENCH_LOOP(bench) {
+        memcpy(data, input, sizeof(input));
+        insertion_sort(data, sizeof(data) / sizeof(data[0]));
+        FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
+    }
+}
+
+FOSSIL_BENCH(selection_sort_bench) {
+    int input[] = {8, 2, 4, 1, 7, 5, 9, 3, 6};
+    int data[sizeof(input) / sizeof(input[0])];
+    FOSSIL_BENCH_SET_ITEMS(bench, sizeof(input) / sizeof(input[0]));
+    FOSSIL_BENCH_LOOP(bench) {
+        memcpy(data, input, sizeof(input));
+        selection_sort(data, sizeof(data) / sizeof(data[0]));
+        FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
+    }
+}
+
+// Sorts in place, the input is restored before every iteration untimed
+static const int reshuffled_input[] = {8, 2, 4, 1, 7, 5, 9, 3, 6};
+static int reshuffled_data[sizeof(reshuffled_input) / sizeof(reshuffled_input[0])];
+
+static void reshuffle(fossil_bench_t *bench) {
+    (void)bench;
+    memcpy(reshuffled_data, reshuffled_input, sizeof(reshuffled_input));
+}
+
+FOSSIL_BENCH(selection_sort_reshuffled) {
+    FOSSIL_BENCH_SETUP_ITERATION(bench, reshuffle);
+    FOSSIL_BENCH_LOOP(bench) {
+        selection_sort(reshuffled_data, sizeof(reshuffled_data) / sizeof(reshuffled_data[0]));
+        FOSSIL_BENCH_DO_NOT_OPTIMIZE(reshuffled_data);
+    }
+}
+
+// Sums a table the caches lose before every cold sample
+static int cold_table[16 * 1024];
+
+FOSSIL_BENCH(sum_table_cold) {
+    FOSSIL_BENCH_COLD_RANGE(bench, cold_table, sizeof(cold_table));
+    FOSSIL_BENCH_LOOP(bench) {
+        int sum = 0;
+        for (size_t i = 0; i < sizeof(cold_table) / sizeof(cold_table[0]); i += 16) {
+            sum += cold_table[i];
+        }
+        FOSSIL_BENCH_DO_NOT_OPTIMIZE(sum);
+    }
+}
+
+#ifndef _WIN32
+// Process startup, every sample is one start of a child
+FOSSIL_BENCH_STARTUP(true_startup, xnull, "true");
+
+FOSSIL_BENCH_ENTRY(sort_entry) {
+    int data[] = {8, 2, 4, 1, 7, 5, 9, 3, 6};
+    insertion_sort(data, sizeof(data) / sizeof(data[0]));
+    return data[0] == 1 ? 0 : 1;
+}
+#endif
+
+// Selection sort over growing inputs, the fit should come out quadratic
+FOSSIL_BENCH_RANGE(selection_sort_sweep, 16, 1024, 4) {
+    static int input[1024];
+    static int data[1024];
+    size_t size = (size_t)bench->arg;
+    uint32_t seed = 12345;
+    FOSSIL_BENCH_SET_BYTES(bench, size * sizeof(int));
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1103515245u + 12345u;
+        input[i] = (int)(seed >> 16);
+    }
+    FOSSIL_BENCH_LOOP(bench) {
+        memcpy(data, input, size * sizeof(int));
+        selection_sort(data, size);
+        FOSSIL_BENCH_DO_NOT_OPTIMIZE(data[0]);
+    }
+}
+
+// The three sorts on one input, interleaved so drift hits them alike
+static const char *const sort_variants[] = { "bubble", "insertion", "selection" };
+
+FOSSIL_BENCH_AB(sort_ab, sort_variants) {
+    int input[32];
+    int data[32];
+    uint32_t seed = 2024;
+    for (size_t i = 0; i < 32; i++) {
+        seed = seed * 1103515245u + 12345u;
+        input[i] = (int)(seed >> 16);
+    }
+    FOSSIL_BENCH_LOOP(bench) {
+        memcpy(data, input, sizeof(input));
+        if (bench->variant == 0) {
+            bubble_sort(data, 32);
+        } else if (bench->variant == 1) {
+            insertion_sort(data, 32);
+        } else {
+            selection_sort(data, 32);
+        }
+        FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
+    }
+}
+
+// Every thread sorts its own copy, so the work scales with the threads
+FOSSIL_BENCH_THREADS(selection_sort_threads) {
+    int input[] = {8, 2, 4, 1, 7, 5, 9, 3, 6, 0, 11, 10};
+    int data[sizeof(input) / sizeof(input[0])];
+    FOSSIL_BENCH_RECORD_LATENCY(bench);
+    FOSSIL_BENCH_LOOP(bench) {
+        memcpy(data, input, sizeof(input));
+        selection_sort(data, sizeof(data) / sizeof(data[0]));
+        FOSSIL_BENCH_DO_NOT_OPTIMIZE(data);
+    }
+}
+
+// Dependent loads through the buffer, every step costs one cache line visit
+FOSSIL_BENCH_WORKING_SET(chase_working_set) {
+    void *at = bench->working_set;
+    FOSSIL_BENCH_SET_ITEMS(bench, 4096);
+    FOSSIL_BENCH_LOOP(bench) {
+        at = FOSSIL_BENCH_WORKING_SET_CHASE(at, 4096);
+        FOSSIL_BENCH_DO_NOT_OPTIMIZE(at);
+    }
+}
+
+FOSSIL_TEST(bench_working_set_chase_cycles) {
+    void *lines[4][8]; // four fake cache lines linked as one cycle
+    lines[0][0] = lines[2];
+    lines[2][0] = lines[1];
+    lines[1][0] = lines[3];
+    lines[3][0] = lines[0];
+    ASSUME_ITS_TRUE(FOSSIL_BENCH_WORKING_SET_CHASE(lines[0], 4) == (void*)lines[0]);
+    ASSUME_ITS_TRUE(FOSSIL_BENCH_WORKING_SET_CHASE(lines[0], 3) == (void*)lines[3]);
+    ASSUME_ITS_TRUE(_fossil_test_get_cache_line_size() >= 16);
+    size_t l1 = _fossil_test_get_cache_size(1);
+    size_t l3 = _fossil_test_get_cache_size(3);
+    ASSUME_ITS_TRUE(l1 == 0 || l3 == 0 || l1 < l3); // unknown levels are 0
+}
+
+FOSSIL_TEST(bench_histogram_percentiles_within_bound) {
+    static fossil_bench_histogram_t low;
+    static fossil_bench_histogram_t high;
+    fossil_bench_histogram_reset(&low);
+    fossil_bench_histogram_reset(&high);
+    for (uint64_t value = 1; value <= 50000; value++) {
+        fossil_bench_histogram_record(&low, value);
+        fossil_bench_histogram_record(&high, value + 50000);
+    }
+    fossil_bench_histogram_record(&high, 5000000000ULL); // one 5 s stall in the tail
+    fossil_bench_histogram_merge(&low, &high);
+
+    ASSUME_ITS_EQUAL_U64(low.count, 100001);
+    ASSUME_ITS_EQUAL_U64(low.min, 1);
+    ASSUME_ITS_EQUAL_U64(low.max, 5000000000ULL);
+    uint64_t p50 = fossil_bench_histogram_percentile(&low, 50.0);
+    uint64_t p99 = fossil_bench_histogram_percentile(&low, 99.0);
+    ASSUME_ITS_TRUE(p50 >= 50001 && (double)p50 <= 50001 * 1.008);
+    ASSUME_ITS_TRUE(p99 >= 99000 && (double)p99 <= 99000 * 1.008);
+    uint64_t tail = fossil_bench_histogram_percentile(&low, 99.999);
+    ASSUME_ITS_TRUE(tail >= 100000 && (double)tail <= 100000 * 1.008);
+    ASSUME_ITS_EQUAL_U64(fossil_bench_histogram_percentile(&low, 100.0), 5000000000ULL);
+    ASSUME_ITS_EQUAL_U64(fossil_bench_histogram_percentile(&low, 0.0), 1);
+}
+
+FOSSIL_TEST(bench_fit_picks_complexity) {
+    double sizes[] = { 16.0, 64.0, 256.0, 1024.0, 4096.0 };
+    double quadratic[5];
+    double linearithmic[5];
+    double constant[5];
+    for (int32_t i = 0; i < 5; i++) {
+        quadratic[i] = 0.5 * sizes[i] * sizes[i] + 10.0;
+        linearithmic[i] = 2.0 * sizes[i] * log2(sizes[i]);
+        constant[i] = 40.0 + (double)(i % 2);
+    }
+
+    fossil_bench_fit_t fit;
+    fossil_bench_fit(sizes, quadratic, 5, &fit);
+    ASSUME_ITS_TRUE(fit.valid);
+    ASSUME_ITS_TRUE(fit.complexity == FOSSIL_BENCH_O_N_SQUARED);
+    ASSUME_ITS_TRUE(fit.coefficient_ns > 0.49 && fit.coefficient_ns < 0.51);
+
+    fossil_bench_fit(sizes, linearithmic, 5, &fit);
+    ASSUME_ITS_TRUE(fit.complexity == FOSSIL_BENCH_O_N_LOG_N);
+    fossil_bench_fit(sizes, constant, 5, &fit);
+    ASSUME_ITS_TRUE(fit.complexity == FOSSIL_BENCH_O_1);
+    fossil_bench_fit(sizes, constant, 1, &fit);
+    ASSUME_ITS_FALSE(fit.valid);
+}
+
+FOSSIL_TEST(bench_stats_reject_outliers) {
+    double samples[] = {10.0, 11.0, 12.0, 10.0, 11.0, 12.0, 11.0, 1000.0};
+    fossil_bench_stats_t stats;
+    fossil_bench_stats(samples, 8, &stats);
+
+    ASSUME_ITS_EQUAL_I32(1, stats.outliers);
+    ASSUME_ITS_EQUAL_I32(7, stats.samples);
+    ASSUME_ITS_TRUE(stats.min_ns == 10.0);
+    ASSUME_ITS_TRUE(stats.max_ns == 12.0);
+    ASSUME_ITS_TRUE(stats.median_ns == 11.0);
+    ASSUME_ITS_TRUE(stats.mean_ns == 11.0);
+    ASSUME_ITS_TRUE(stats.mad_ns == 1.0);
+    ASSUME_ITS_TRUE(stats.p99_ns == 12.0);
+}
+
+static int32_t bench_case_calls = 0;
+
+static void bench_case_counted(void) {
+    bench_case_calls++;
+}
+
+FOSSIL_TEST(bench_case_takes_one_sample_per_call) {
+    static fossil_bench_t bench;
+    bench_case_calls = 0;
+    fossil_bench_run_case(&bench, "bench_case_counted", bench_case_counted);
+    ASSUME_ITS_EQUAL_I32(bench.sample_count + 1, bench_case_calls); // one call warms up
+    ASSUME_ITS_TRUE(bench.sample_count > 0);
+    ASSUME_ITS_EQUAL_U64(1, bench.iterations);
+    ASSUME_ITS_EQUAL_I32(bench.sample_count, bench.stats.samples + bench.stats.outliers);
+}
+
+static void spin_setup(fossil_bench_t *bench) {
+    (void)bench;
+    spin_for_ns(20000);
+}
+
+static void spin_setup_body(fossil_bench_t *bench) {
+    FOSSIL_BENCH_SETUP_ITERATION(bench, spin_setup);
+    FOSSIL_BENCH_LOOP(bench) {
+        FOSSIL_BENCH_DO_NOT_OPTIMIZE(bench->iterations);
+    }
+}
+
+FOSSIL_TEST(bench_iteration_setup_is_not_timed) {
+    static fossil_bench_t bench;
+    fossil_bench_run(&bench, "spin_setup", spin_setup_body);
+    ASSUME_ITS_TRUE(bench.stats.samples > 0);
+    // a timed setup would make every iteration spin 20 us or more
+    ASSUME_ITS_TRUE(bench.stats.median_ns < 20000.0);
+}
+
+static void spin_paused_body(fossil_bench_t *bench) {
+    FOSSIL_BENCH_LOOP(bench) {
+        spin_for_ns(1000);
+        FOSSIL_BENCH_PAUSE(bench);
+        spin_for_ns(20000);
+        FOSSIL_BENCH_RESUME(bench);
+    }
+}
+
+FOSSIL_TEST(bench_pause_excludes_part_of_iteration) {
+    static fossil_bench_t bench;
+    fossil_bench_run(&bench, "spin_paused", spin_paused_body);
+    ASSUME_ITS_TRUE(bench.stats.samples > 0);
+    // every iteration spins 1 us timed, 21 us or more would mean the pause counted
+    ASSUME_ITS_TRUE(bench.stats.median_ns > 500.0 && bench.stats.median_ns < 21000.0);
+}
+
+static void cold_table_body(fossil_bench_t *bench) {
+    FOSSIL_BENCH_COLD(bench);
+    FOSSIL_BENCH_COLD_BRANCHES(bench);
+    FOSSIL_BENCH_LOOP(bench) {
+        int sum = 0;
+        for (size_t i = 0; i < sizeof(cold_table) / sizeof(cold_table[0]); i += 16) {
+            sum += cold_table[i];
+        }
+        FOSSIL_BENCH_DO_NOT_OPTIMIZE(sum);
+    }
+}
+
+FOSSIL_TEST(bench_cold_samples_are_kept_apart) {
+    static fossil_bench_t bench;
+    fossil_bench_run(&bench, "cold_table", cold_table_body);
+    ASSUME_ITS_EQUAL_I32(FOSSIL_BENCH_SAMPLES, bench.cold_count);
+    ASSUME_ITS_EQUAL_I32(bench.cold_count, bench.cold_stats.samples + bench.cold_stats.outliers);
+    // whether cold samples come out slower depends on the machine, only that
+    // they were taken apart from the warm ones is checked
+    ASSUME_ITS_TRUE(bench.cold_stats.samples > 0 && bench.cold_stats.median_ns > 0.0);
+    ASSUME_ITS_TRUE(bench.stats.samples > 0);
+    ASSUME_ITS_TRUE(bench.latency == xnull);
+}
+
+#ifndef _WIN32
+static int ready_then_spin(void) {
+    FOSSIL_BENCH_READY();
+    spin_for_ns(50000000);
+    return 0;
+}
+
+FOSSIL_TEST(bench_entry_is_timed_until_ready) {
+    static fossil_bench_t bench;
+    fossil_bench_run_entry(&bench, "ready_then_spin", ready_then_spin);
+    ASSUME_ITS_EQUAL_I32(FOSSIL_BENCH_SAMPLES, bench.sample_count);
+    ASSUME_ITS_TRUE(bench.stats.median_ns < 50000000.0); // timing past ready would include the 50 ms spin
+}
+
+FOSSIL_TEST(bench_startup_is_timed_until_marker) {
+    static fossil_bench_t bench;
+    static const char *const argv[] = { "sh", "-c", "echo listening; sleep 1", xnull };
+    fossil_bench_run_startup(&bench, "sh_listening", argv, "listening");
+    ASSUME_ITS_EQUAL_I32(FOSSIL_BENCH_SAMPLES, bench.sample_count);
+    ASSUME_ITS_TRUE(bench.stats.median_ns < 1000000000.0); // timing past the marker would include the 1 s sleep
+}
+#endif
+
+static const char *const spin_variants[] = { "slow", "fast" };
+
+static void spin_variant_body(fossil_bench_t *bench) {
+    spin_for_ns(bench->variant == 0 ? 20000 : 10000);
+}
+
+FOSSIL_TEST(bench_ab_interleaves_and_finds_speedup) {
+    static fossil_bench_ab_t ab;
+    fossil_bench_run_ab(&ab, "spin_ab", spin_variant_body, spin_variants, 2);
+    ASSUME_ITS_EQUAL_I32(2, ab.variant_count);
+    ASSUME_ITS_EQUAL_I32(ab.points[0]->sample_count, ab.points[1]->sample_count);
+    ASSUME_ITS_EQUAL_CSTR("spin_ab/fast", ab.points[1]->name);
+    ASSUME_ITS_TRUE(ab.versus[0].delta == 0.0);
+    // the fast variant spins half as long; how much faster it measures depends on the load
+    ASSUME_ITS_TRUE(ab.versus[1].delta < 0.0);
+    ASSUME_ITS_TRUE(ab.versus[1].delta_low <= ab.versus[1].delta && ab.versus[1].delta <= ab.versus[1].delta_high);
+}
+
+FOSSIL_TEST(bench_stats_of_no_samples) {
+    fossil_bench_stats_t stats;
+    fossil_bench_stats(xnull, 0, &stats);
+    ASSUME_ITS_EQUAL_I32(0, stats.samples);
+    ASSUME_ITS_TRUE(stats.median_ns == 0.0);
+}
+
+FOSSIL_TEST(bench_timer_pause_excludes_time) {
+    fossil_bench_timer_t timer;
+    fossil_bench_timer_start(&timer);
+    fossil_bench_timer_pause(&timer);
+    spin_for_ns(20000000);
+    fossil_bench_timer_resume(&timer);
+    ASSUME_ITS_LESS_THAN_U64(fossil_bench_timer_stop(&timer), 20000000);
+}
+
+FOSSIL_TEST(bench_timer_laps_add_up) {
+    fossil_bench_timer_t timer;
+    fossil_bench_timer_start(&timer);
+    spin_for_ns(1000000);
+    uint64_t first = fossil_bench_timer_lap(&timer);
+    spin_for_ns(1000000);
+    uint64_t second = fossil_bench_timer_lap(&timer);
+    uint64_t total = fossil_bench_timer_stop(&timer);
+
+    ASSUME_ITS_TRUE(first > 0);
+    ASSUME_ITS_TRUE(second > 0);
+    ASSUME_ITS_LESS_OR_EQUAL_U64(first + second, total);
+}
+
+FOSSIL_TEST(bench_timer_nested_blocks) {
+    uint64_t inner = 0;
+    TEST_BENCHMARK();
+    {
+        fossil_bench_timer_t timer;
+        fossil_bench_timer_start(&timer);
+        spin_for_ns(1000000);
+        inner = fossil_bench_timer_stop(&timer);
+    }
+    uint64_t outer = TEST_CURRENT_TIME();
+
+    ASSUME_ITS_TRUE(inner > 0);
+    ASSUME_ITS_MORE_OR_EQUAL_U64(outer, inner);
+}
+
+FOSSIL_TEST(bench_timer_macro_is_an_expression) {
+    bool restart = true;
+    TEST_BENCHMARK();
+    spin_for_ns(1000000);
+    uint64_t first = TEST_CURRENT_TIME();
+    if (restart)
+        TEST_BENCHMARK();
+    TEST_BENCHMARK(); // a second use in the same scope restarts the timer
+    uint64_t second = TEST_CURRENT_TIME();
+
+    ASSUME_ITS_TRUE(first > 0);
+    ASSUME_ITS_LESS_OR_EQUAL_U64(second, TEST_CURRENT_TIME());
+    ASSUME_ITS_EQUAL_U64(fossil_test_stop_benchmark(), fossil_test_stop_benchmark());
+}
+
+FOSSIL_TEST(bench_clock_matches_monotonic) {
+    fossil_bench_clock_calibrate();
+    ASSUME_ITS_TRUE(_BENCH_CLOCK.calibrated);
+    ASSUME_ITS_TRUE(_BENCH_CLOCK.ns_per_tick > 0.0);
+
+    uint64_t ticks_start = fossil_bench_ticks_start();
+    uint64_t ns_start = fossil_test_clock_ns();
+    spin_for_ns(5000000);
+    uint64_t ns_end = fossil_test_clock_ns();
+    uint64_t ticks_end = fossil_bench_ticks_stop();
+
+    // both clocks saw the same interval; a preempted calibration skews the rate,
+    // a wrong unit or a zero rate would be off by far more than a factor of two
+    uint64_t monotonic = ns_end - ns_start;
+    uint64_t ticked = fossil_bench_ticks_to_ns(ticks_end - ticks_start);
+    ASSUME_ITS_MORE_OR_EQUAL_U64(ticked, monotonic / 2);
+    ASSUME_ITS_LESS_OR_EQUAL_U64(ticked, monotonic * 2);
+}
+
+FOSSIL_TEST(bench_counters_accumulate_valid_events) {
+    fossil_bench_counters_t total = {{false}, {0}};
+    fossil_bench_counters_t begin = {{false}, {0}};
+    fossil_bench_counters_t end = {{false}, {0}};
+    begin.valid[FOSSIL_BENCH_COUNTER_CYCLES] = end.valid[FOSSIL_BENCH_COUNTER_CYCLES] = true;
+    begin.value[FOSSIL_BENCH_COUNTER_CYCLES] = 100;
+    end.value[FOSSIL_BENCH_COUNTER_CYCLES] = 350;
+    end.valid[FOSSIL_BENCH_COUNTER_INSTRUCTIONS] = true; // missing from the first reading
+    end.value[FOSSIL_BENCH_COUNTER_INSTRUCTIONS] = 999;
+
+    fossil_bench_counters_accumulate(&total, &begin, &end);
+    fossil_bench_counters_accumulate(&total, &begin, &end);
+
+    ASSUME_ITS_TRUE(total.valid[FOSSIL_BENCH_COUNTER_CYCLES]);
+    ASSUME_ITS_EQUAL_U64(total.value[FOSSIL_BENCH_COUNTER_CYCLES], 500);
+    ASSUME_ITS_FALSE(total.valid[FOSSIL_BENCH_COUNTER_INSTRUCTIONS]);
+    ASSUME_ITS_EQUAL_CSTR("cycles", fossil_bench_counters_name(FOSSIL_BENCH_COUNTER_CYCLES));
+}
+
+FOSSIL_TEST(bench_mann_whitney_separates_shifted_samples) {
+    double before[20];
+    double after[20];
+    for (int32_t i = 0; i < 20; i++) {
+        before[i] = 100.0 + (double)(i % 5);
+        after[i] = 120.0 + (double)(i % 5);
+    }
+    double z = 0.0;
+    double p = fossil_bench_mann_whitney(before, 20, after, 20, &z);
+    ASSUME_ITS_TRUE(p < 0.001);
+    ASSUME_ITS_TRUE(z > 0.0);
+
+    fossil_bench_compare_t compare;
+    fossil_bench_compare(before, 20, after, 20, 0.05, &compare);
+    ASSUME_ITS_TRUE(compare.verdict == FOSSIL_BENCH_VERDICT_SLOWER);
+    fossil_bench_compare(after, 20, before, 20, 0.05, &compare);
+    ASSUME_ITS_TRUE(compare.verdict == FOSSIL_BENCH_VERDICT_FASTER);
+}
+
+FOSSIL_TEST(bench_compare_interval_covers_shift) {
+    double before[20];
+    double after[20];
+    for (int32_t i = 0; i < 20; i++) {
+        before[i] = 100.0 + (double)(i % 5);
+        after[i] = 120.0 + (double)(i % 5);
+    }
+
+    // every pair differs by 16 to 24 ns, the interval of the 20% change lies inside
+    fossil_bench_compare_t compare;
+    fossil_bench_compare(before, 20, after, 20, 0.05, &compare);
+    ASSUME_ITS_TRUE(compare.delta_low > 0.0);
+    ASSUME_ITS_TRUE(compare.delta_low <= compare.delta && compare.delta <= compare.delta_high);
+    ASSUME_ITS_TRUE(compare.delta_high < 0.25);
+
+    // no change gives an interval around 0
+    fossil_bench_compare(before, 20, before, 20, 0.05, &compare);
+    ASSUME_ITS_TRUE(compare.delta_low <= 0.0 && compare.delta_high >= 0.0);
+}
+
+FOSSIL_TEST(bench_compare_command_needs_two_files) {
+    char *missing[] = { "xcli", "compare", "old.txt" };
+    fossil_options_t options = fossil_options_parse(3, missing);
+    ASSUME_ITS_TRUE(options.compare_enabled);
+    ASSUME_ITS_EQUAL_CSTR("", options.compare_new_file); // reported as a usage error, not run as a suite
+
+    char *both[] = { "xcli", "compare", "old.txt", "new.txt", "json" };
+    options = fossil_options_parse(5, both);
+    ASSUME_ITS_TRUE(options.compare_enabled && options.compare_json);
+    ASSUME_ITS_EQUAL_CSTR("old.txt", options.compare_old_file);
+    ASSUME_ITS_EQUAL_CSTR("new.txt", options.compare_new_file);
+}
+
+FOSSIL_TEST(bench_history_sums_every_variant) {
+    static fossil_bench_record_t plain = { .name = "sort", .iterations = 10, .sample_count = 2, .samples = { 100.0, 300.0 } };
+    static fossil_bench_record_t small = { .name = "sort_range/8", .iterations = 4, .sample_count = 1, .samples = { 50.0 } };
+    static fossil_bench_record_t large = { .name = "sort_range/64", .iterations = 2, .sample_count = 1, .samples = { 500.0 } };
+    plain.next = &small;
+    small.next = &large;
+
+    ASSUME_ITS_EQUAL_U64(4000, fossil_bench_history_ns(&plain, "sort"));
+    ASSUME_ITS_EQUAL_U64(1200, fossil_bench_history_ns(&plain, "sort_range"));
+    ASSUME_ITS_EQUAL_U64(0, fossil_bench_history_ns(&plain, "sort_r"));
+    ASSUME_ITS_EQUAL_U64(0, fossil_bench_history_ns(xnull, "sort"));
+}
+
+FOSSIL_TEST(bench_mann_whitney_keeps_same_samples) {
+    double samples[] = { 10.0, 11.0, 12.0, 10.5, 11.5, 10.0, 12.5, 11.0 };
+    double z = 0.0;
+    double p = fossil_bench_mann_whitney(samples, 8, samples, 8, &z);
+    ASSUME_ITS_TRUE(p > 0.9);
+
+    // a shift inside the threshold is never a regression
+    double slower[8];
+    for (int32_t i = 0; i < 8; i++) {
+        slower[i] = samples[i] * 1.03;
+    }
+    fossil_bench_compare_t compare;
+    fossil_bench_compare(samples, 8, slower, 8, 0.05, &compare);
+    ASSUME_ITS_TRUE(compare.verdict == FOSSIL_BENCH_VERDICT_SAME);
+}
+
+FOSSIL_TEST(bench_host_description_is_one_record) {
+    char host[512];
+    fossil_bench_host_describe(host, sizeof(host));
+    ASSUME_NOT_CNULL(strstr(host, " cpu "));
+    ASSUME_NOT_CNULL(strstr(host, " kernel "));
+    ASSUME_ITS_CNULL(strchr(host, '\n'));
+
+    char tiny[12];
+    fossil_bench_host_describe(tiny, sizeof(tiny));
+    ASSUME_ITS_TRUE(strlen(tiny) < sizeof(tiny));
+}
+
+FOSSIL_TEST(allocs_count_malloc_realloc_free) {
+    TEST_ALLOCS();
+    char *volatile block = (char*)malloc(100);
+    block = (char*)realloc(block, 200);
+    free(block);
+    uint64_t made = TEST_ALLOCS_ENDED();
+    if (!fossil_test_allocs_available()) {
+        ASSUME_ITS_EQUAL_U64(made, 0);
+        return;
+    }
+    ASSUME_ITS_EQUAL_U64(made, 2);
+    ASSUME_ITS_EQUAL_U64(_fossil_test_allocs.frees, 2);
+    ASSUME_ITS_EQUAL_U64(_fossil_test_allocs.bytes, 300);
+    ASSUME_ITS_TRUE(_fossil_test_allocs.peak_bytes >= 200);
+}
+
+#ifndef _WIN32
+FOSSIL_TEST(allocs_count_aligned_blocks) {
+    void *aligned = xnull;
+    TEST_ALLOCS();
+    int failed = posix_memalign(&aligned, 64, 128);
+    void *volatile other = aligned_alloc(64, 256);
+    bool aligned_other = (uintptr_t)other % 64 == 0;
+    free(aligned);
+    free(other);
+    uint64_t made = TEST_ALLOCS_ENDED();
+    ASSUME_ITS_EQUAL_I32(0, failed);
+    ASSUME_ITS_TRUE(aligned_other);
+    if (!fossil_test_allocs_available()) {
+        ASSUME_ITS_EQUAL_U64(made, 0);
+        return;
+    }
+    ASSUME_ITS_EQUAL_U64(made, 2);
+    ASSUME_ITS_EQUAL_U64(_fossil_test_allocs.frees, 2); // every free has its allocation
+    ASSUME_ITS_EQUAL_U64(_fossil_test_allocs.bytes, 384);
+}
+#endif
+
+FOSSIL_TEST(allocs_none_while_sorting) {
+    int data[] = {8, 2, 4, 1, 7, 5, 9, 3, 6};
+    TEST_ALLOCS();
+    insertion_sort(data, sizeof(data) / sizeof(data[0]));
+    ASSUME_ITS_EQUAL_U64(TEST_ALLOCS_ENDED(), 0);
+    ASSUME_ITS_EQUAL_I32(1, data[0]);
+}
+
 // XUNIT-GROUP
 FOSSIL_TEST_GROUP(benchmark_group) {
     APPLY_MARK(bubble_sort_case_1, "ghost");
@@ -163,10 +760,13 @@ FOSSIL_TEST_GROUP(benchmark_group) {
     ADD_TEST(bubble_sort_case_3);
 
     APPLY_MARK(insertion_sort_case_1, "ghost");
+    APPLY_XTAG(insertion_sort_case_1, "performance");
     ADD_TEST(insertion_sort_case_1);
     APPLY_MARK(insertion_sort_case_2, "ghost");
+    APPLY_XTAG(insertion_sort_case_2, "performance");
     ADD_TEST(insertion_sort_case_2);
     APPLY_MARK(insertion_sort_case_3, "ghost");
+    APPLY_XTAG(insertion_sort_case_3, "performance");
     ADD_TEST(insertion_sort_case_3);
 
     APPLY_MARK(selection_sort_case_1, "ghost");
@@ -175,4 +775,49 @@ FOSSIL_TEST_GROUP(benchmark_group) {
     ADD_TEST(selection_sort_case_2);
     APPLY_MARK(selection_sort_case_3, "ghost");
     ADD_TEST(selection_sort_case_3);
+
+    ADD_TEST(bubble_sort_latency);
+    ADD_TEST(insertion_sort_bench);
+    ADD_TEST(selection_sort_bench);
+    ADD_TEST(selection_sort_reshuffled);
+    ADD_TEST(sum_table_cold);
+#ifndef _WIN32
+    ADD_TEST(true_startup);
+    ADD_TEST(sort_entry);
+#endif
+    ADD_TEST(selection_sort_sweep);
+    ADD_TEST(selection_sort_threads);
+    ADD_TEST(sort_ab);
+    ADD_TEST(chase_working_set);
+    ADD_TEST(bench_stats_reject_outliers);
+    ADD_TEST(bench_stats_of_no_samples);
+    ADD_TEST(bench_case_takes_one_sample_per_call);
+    ADD_TEST(bench_iteration_setup_is_not_timed);
+    ADD_TEST(bench_pause_excludes_part_of_iteration);
+    ADD_TEST(bench_cold_samples_are_kept_apart);
+#ifndef _WIN32
+    ADD_TEST(bench_entry_is_timed_until_ready);
+    ADD_TEST(bench_startup_is_timed_until_marker);
+#endif
+    ADD_TEST(bench_ab_interleaves_and_finds_speedup);
+    ADD_TEST(bench_timer_pause_excludes_time);
+    ADD_TEST(bench_timer_laps_add_up);
+    ADD_TEST(bench_timer_nested_blocks);
+    ADD_TEST(bench_timer_macro_is_an_expression);
+    ADD_TEST(bench_clock_matches_monotonic);
+    ADD_TEST(bench_counters_accumulate_valid_events);
+    ADD_TEST(bench_mann_whitney_separates_shifted_samples);
+    ADD_TEST(bench_mann_whitney_keeps_same_samples);
+    ADD_TEST(bench_compare_interval_covers_shift);
+    ADD_TEST(bench_compare_command_needs_two_files);
+    ADD_TEST(bench_history_sums_every_variant);
+    ADD_TEST(bench_working_set_chase_cycles);
+    ADD_TEST(bench_histogram_percentiles_within_bound);
+    ADD_TEST(bench_fit_picks_complexity);
+    ADD_TEST(bench_host_description_is_one_record);
+    ADD_TEST(allocs_count_malloc_realloc_free);
+#ifndef _WIN32
+    ADD_TEST(allocs_count_aligned_blocks);
+#endif
+    ADD_TEST(allocs_none_while_sorting);
 }
@@ -0,0 +1,71 @@
+/*
+==============================================================================
+Author: Michael Gene Brockus (Dreamer)
+Email: michaelbrockus@gmail.com
+Organization: Fossil Logic
+Description:
+    This file is part of the Fossil Logic project, where innovation meets
+    excellence in software development. Michael Gene Brockus, also known as
+    "Dreamer," is a dedicated contributor to this project. For any inquiries,
+    feel free to contact Michael at michaelbrockus@gmail.com.
+==============================================================================
+*/
+#include <fossil/unittest.h>   // basic test tools
+#include <fossil/xassume.h> // extra asserts
+#include <fossil/unittest/commands.h> // runner options
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Utilites
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// Setup steps for things like test fixtures and
+// mock objects are set here.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+// While capture is on, stdout of a case is a seekable buffer that starts
+// empty for every case, a terminal or a pipe is never seekable.
+static long capture_stdout_offset(void) {
+#ifndef _WIN32
+    fflush(stdout);
+    return (long)lseek(STDOUT_FILENO, 0, SEEK_CUR);
+#else
+    return -1;
+#endif
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Cases
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// The test cases below are provided as samples, inspired
+// by the Meson build system's approach of using test cases
+// as samples for library usage.
+// * * * * * * * * * * * * * * * * * * * * * * * *
+
+FOSSIL_TEST(capture_case_output_is_buffered) {
+    long before = capture_stdout_offset();
+    printf("this line only shows up when the case fails\n");
+    fprintf(stderr, "and so does this one\n");
+    if (fossil_test_io_capture_active()) {
+        ASSUME_ITS_EQUAL_I64(before + 44, capture_stdout_offset());
+    }
+}
+
+FOSSIL_TEST(capture_buffer_starts_empty) {
+    long offset = capture_stdout_offset();
+#ifndef _WIN32
+    if (_CLI.capture_enabled) {
+        // without capture stdout may be a file that is far from empty
+        ASSUME_ITS_TRUE(fossil_test_io_capture_active());
+        ASSUME_ITS_EQUAL_I64(0, offset);
+    }
+#else
+    ASSUME_ITS_EQUAL_I64(-1, offset);
+#endif
+}
+
+// * * * * * * * * * * * * * * * * * * * * * * * *
+// * Fossil Logic Test Pool
+// * * * * * * * * * * * * * * * * * * * * * * * *
+FOSSIL_TEST_GROUP(capture_group) {
+    ADD_TEST(capture_case_output_is_buffered);
+    ADD_TEST(capture_buffer_starts_empty);
+} // end of fixture
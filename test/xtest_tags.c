@@ -11,6 +11,8 @@ Description:
 ==============================================================================
 */
 #include <fossil/unittest.h>
+#include <fossil/xassume.h> // extra asserts
+#include <fossil/unittest/commands.h> // runner options
 
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Utilites
@@ -19,7 +21,22 @@ Description:
 // mock objects are set here.
 // * * * * * * * * * * * * * * * * * * * * * * * *
 
-// placeholder
+enum {
+    ONLY_CASES = 5
+};
+
+// Runs the environment algorithms with only set to the given tags on a queue
+// of the given cases, everything else left off
+static void only_filter(fossil_env_t *env, const char *tags) {
+    fossil_options_t options = _CLI;
+    _CLI.only_tags = true;
+    snprintf(_CLI.only_tags_value, sizeof(_CLI.only_tags_value), "%s", tags);
+    _CLI.shuffle_enabled = false;
+    _CLI.reverse = false;
+    _CLI.bench_mode = false;
+    fossil_test_environment_algorithms(env);
+    _CLI = options;
+}
 
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Cases
@@ -77,6 +94,41 @@ FOSSIL_TEST(testing_fake_tags) {
     TEST_ASSERT(y <= x, "Should have passed the test case");
 } // end case
 
+FOSSIL_TEST(testing_only_keeps_tagged_cases) {
+    // the cases are static like registered ones, the filter must not free them
+    static fossil_test_t cases[ONLY_CASES];
+    static char *tags[ONLY_CASES] = { "fast", "slow", "fossil", "fast", "performance" };
+    fossil_test_queue_t queue = { xnull, xnull };
+    fossil_env_t env;
+    memset(&env, 0, sizeof(env));
+    env.queue = &queue;
+    for (int i = 0; i < ONLY_CASES; i++) {
+        memset(&cases[i], 0, sizeof(cases[i]));
+        cases[i].name = "only case";
+        cases[i].tags = tags[i];
+        cases[i].prev = i > 0 ? &cases[i - 1] : xnull;
+        cases[i].next = i + 1 < ONLY_CASES ? &cases[i + 1] : xnull;
+    }
+    queue.front = &cases[0];
+    queue.rear = &cases[ONLY_CASES - 1];
+
+    only_filter(&env, "fast,performance");
+
+    // Test cases
+    ASSUME_ITS_TRUE(queue.front == &cases[0]);
+    ASSUME_ITS_TRUE(cases[0].next == &cases[3]);
+    ASSUME_ITS_TRUE(cases[3].prev == &cases[0]);
+    ASSUME_ITS_TRUE(cases[3].next == &cases[4]);
+    ASSUME_ITS_TRUE(queue.rear == &cases[4]);
+    ASSUME_ITS_TRUE(cases[1].next == xnull && cases[1].prev == xnull);
+    ASSUME_ITS_TRUE(cases[2].next == xnull && cases[2].prev == xnull);
+
+    // a tag nothing carries leaves an empty queue
+    only_filter(&env, "pizza");
+    ASSUME_ITS_TRUE(queue.front == xnull);
+    ASSUME_ITS_TRUE(queue.rear == xnull);
+} // end case
+
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Pool
 // * * * * * * * * * * * * * * * * * * * * * * * *
@@ -91,4 +143,6 @@ FOSSIL_TEST_GROUP(tags_test_group) {
 
     // No tags should affect this test case
     ADD_TEST(testing_no_tags);
+
+    ADD_TEST(testing_only_keeps_tagged_cases);
 } // end of group
@@ -11,6 +11,8 @@ Description:
 ==============================================================================
 */
 #include <fossil/unittest.h>
+#include <fossil/xassume.h> // extra asserts
+#include <fossil/unittest/commands.h> // runner options
 
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Utilites
@@ -19,7 +21,69 @@ Description:
 // mock objects are set here.
 // * * * * * * * * * * * * * * * * * * * * * * * *
 
-// placeholder
+FOSSIL_TEST_DATA(xdiff_point) {
+    int32_t x;
+    int32_t y;
+    char label[8];
+};
+
+enum {
+    XDIFF_BYTES = 1024, // 64 hexdump rows, more than a failure shows
+    XDIFF_LINES = 40    // lines of text, more than a failure shows
+};
+
+// Renders the operands attached by the comparison just made as a verbose
+// failure shows them, without colors, and reads it back into render. The
+// operands are used up here, as an assertion would.
+static void xdiff_render(char *render, size_t size) {
+    xassert_info info = _ASSERT_INFO;
+    _ASSERT_INFO.operands.kind = TEST_OPERAND_AS_NONE;
+    info.message = "rendered by xdiff_render";
+    info.file = (char*)__FILE__;
+    info.line = __LINE__;
+    info.func = (char*)__func__;
+
+    render[0] = '\0';
+    FILE *out = tmpfile();
+    if (out == xnull) {
+        return;
+    }
+    int verbose_level = _CLI.verbose_level;
+    bool color_enabled = _CLI.color_enabled;
+    _CLI.verbose_level = 2;
+    _CLI.color_enabled = false;
+    FILE *previous = fossil_test_io_console(out);
+    fossil_test_io_asserted(&info);
+    fossil_test_io_console(previous);
+    _CLI.verbose_level = verbose_level;
+    _CLI.color_enabled = color_enabled;
+
+    rewind(out);
+    size_t read = fread(render, 1, size - 1, out);
+    render[read] = '\0';
+    fclose(out);
+}
+
+// Counting bytes, with the actual side changed at 0x125 and 0x3f0
+static void xdiff_bytes(unsigned char *actual, unsigned char *expected) {
+    for (size_t i = 0; i < XDIFF_BYTES; i++) {
+        actual[i] = expected[i] = (unsigned char)i;
+    }
+    actual[0x125] = 0xee;
+    actual[0x3f0] = 0xee;
+}
+
+// Lines "line 1" up to "line XDIFF_LINES", the given line replaced
+static void xdiff_lines(char *text, size_t size, int32_t changed, const char *replacement) {
+    size_t used = 0;
+    for (int32_t line = 1; line <= XDIFF_LINES && used < size; line++) {
+        if (line == changed) {
+            used += (size_t)snprintf(text + used, size - used, "%s\n", replacement);
+        } else {
+            used += (size_t)snprintf(text + used, size - used, "line %d\n", (int)line);
+        }
+    }
+}
 
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Cases
@@ -89,6 +153,110 @@ FOSSIL_TEST(xassert_run_of_int64) {
     TEST_ASSERT((int64_t)y <= (int64_t)x, "Should have passed the test case");
 } // end case
 
+FOSSIL_TEST(xassert_run_of_memory_compare) {
+    xdiff_point_xdata lhs = { 1, 2, "origin" };
+    xdiff_point_xdata rhs = { 1, 2, "origin" };
+    xdiff_point_xdata other = { 1, 3, "origin" };
+
+    // Test cases
+    ASSUME_ITS_EQUAL_MEM(&lhs, &rhs, sizeof(lhs));
+    ASSUME_NOT_EQUAL_MEM(&lhs, &other, sizeof(lhs));
+    ASSUME_ITS_TRUE(_fossil_test_compare_bytes(xnull, xnull, 4));
+    ASSUME_ITS_FALSE(_fossil_test_compare_bytes(&lhs, xnull, sizeof(lhs)));
+} // end case
+
+FOSSIL_TEST(xassert_run_of_text_compare) {
+    const char *text = "line one\nline two";
+
+    // Test cases
+    ASSUME_ITS_EQUAL_CSTR(text, "line one\nline two");
+    ASSUME_NOT_EQUAL_CSTR(text, "line one\nline 2");
+    ASSUME_ITS_TRUE(_fossil_test_compare_text(xnull, xnull));
+    ASSUME_ITS_FALSE(_fossil_test_compare_text(text, xnull));
+} // end case
+
+// Marked to fail, the buffers differ
+FOSSIL_TEST(xassert_fail_of_memory_compare) {
+    static unsigned char actual[XDIFF_BYTES];
+    static unsigned char expected[XDIFF_BYTES];
+    xdiff_bytes(actual, expected);
+
+    // Test cases
+    ASSUME_ITS_EQUAL_MEM(actual, expected, sizeof(actual));
+} // end case
+
+FOSSIL_TEST(xassert_diff_of_memory_compare) {
+    static unsigned char actual[XDIFF_BYTES];
+    static unsigned char expected[XDIFF_BYTES];
+    static char render[4096];
+    xdiff_bytes(actual, expected);
+    bool same = _fossil_test_compare_bytes(actual, expected, sizeof(actual));
+    xdiff_render(render, sizeof(render));
+
+    // Test cases
+    ASSUME_ITS_FALSE(same);
+    ASSUME_NOT_CNULL(strstr(render, "1024 bytes, 2 differ, first at offset 0x125"));
+    // two rows of context before the first difference, then the 16 row cap
+    ASSUME_ITS_CNULL(strstr(render, "000000f0  "));
+    ASSUME_NOT_CNULL(strstr(render, "  00000100  00 01 02"));
+    ASSUME_NOT_CNULL(strstr(render, "> 00000120  20 21 22 23 24 ee 26"));
+    ASSUME_NOT_CNULL(strstr(render, "| 20 21 22 23 24 25 26"));
+    ASSUME_NOT_CNULL(strstr(render, "  000001f0  f0 f1"));
+    ASSUME_ITS_CNULL(strstr(render, "00000200  "));
+    ASSUME_NOT_CNULL(strstr(render, "... 32 more row(s) not shown"));
+} // end case
+
+FOSSIL_TEST(xassert_diff_of_memory_lengths) {
+    unsigned char bytes[24];
+    static char render[4096];
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        bytes[i] = (unsigned char)i;
+    }
+    // the same bytes, the expected side four longer
+    _fossil_test_compare_bytes(bytes, bytes, 20);
+    _ASSERT_INFO.operands.expected_size = sizeof(bytes);
+    xdiff_render(render, sizeof(render));
+
+    // Test cases
+    ASSUME_NOT_CNULL(strstr(render, "actual 20 bytes, expected 24 bytes, 4 differ, first at offset 0x14"));
+    ASSUME_NOT_CNULL(strstr(render, "  00000000  00 01 02"));
+    ASSUME_NOT_CNULL(strstr(render, "> 00000010  10 11 12 13 "));
+    ASSUME_NOT_CNULL(strstr(render, "| 10 11 12 13 14 15 16 17"));
+} // end case
+
+// Marked to fail, the texts differ
+FOSSIL_TEST(xassert_fail_of_text_compare) {
+    static char actual[XDIFF_LINES * 16];
+    static char expected[XDIFF_LINES * 16];
+    xdiff_lines(actual, sizeof(actual), 20, "line 20");
+    xdiff_lines(expected, sizeof(expected), 20, "line 2O");
+
+    // Test cases
+    ASSUME_ITS_EQUAL_CSTR(actual, expected);
+} // end case
+
+FOSSIL_TEST(xassert_diff_of_text_compare) {
+    static char actual[XDIFF_LINES * 16];
+    static char expected[XDIFF_LINES * 16];
+    static char render[4096];
+    xdiff_lines(actual, sizeof(actual), 20, "line 20");
+    xdiff_lines(expected, sizeof(expected), 20, "line 2O");
+    bool same = _fossil_test_compare_text(actual, expected);
+    xdiff_render(render, sizeof(render));
+
+    // Test cases
+    ASSUME_ITS_FALSE(same);
+    ASSUME_NOT_CNULL(strstr(render, "first difference at line 20 column 7"));
+    // two lines of context before the first difference, then the 16 line cap
+    ASSUME_ITS_CNULL(strstr(render, "   17  line 17"));
+    ASSUME_NOT_CNULL(strstr(render, "   18  line 18"));
+    ASSUME_NOT_CNULL(strstr(render, ">   20  line 20"));
+    ASSUME_NOT_CNULL(strstr(render, "| line 2O"));
+    ASSUME_NOT_CNULL(strstr(render, "   33  line 33"));
+    ASSUME_ITS_CNULL(strstr(render, "   34  line 34"));
+    ASSUME_NOT_CNULL(strstr(render, "... more lines not shown"));
+} // end case
+
 // * * * * * * * * * * * * * * * * * * * * * * * *
 // * Fossil Logic Test Pool
 // * * * * * * * * * * * * * * * * * * * * * * * *
@@ -98,4 +266,13 @@ FOSSIL_TEST_GROUP(tdd_test_group) {
     ADD_TEST(xassert_run_of_int16);
     ADD_TEST(xassert_run_of_int32);
     ADD_TEST(xassert_run_of_int64);
+    ADD_TEST(xassert_run_of_memory_compare);
+    ADD_TEST(xassert_run_of_text_compare);
+    APPLY_MARK(xassert_fail_of_memory_compare, "fail");
+    ADD_TEST(xassert_fail_of_memory_compare);
+    ADD_TEST(xassert_diff_of_memory_compare);
+    ADD_TEST(xassert_diff_of_memory_lengths);
+    APPLY_MARK(xassert_fail_of_text_compare, "fail");
+    ADD_TEST(xassert_fail_of_text_compare);
+    ADD_TEST(xassert_diff_of_text_compare);
 } // end of group